@@ -3,8 +3,21 @@
 
 #include "InteractionComponent.h"
 #include "SurvivalCharacter.h"
-#include "ConstructorHelpers.h"
-#include "Widgets/InteractionWidget.h"
+#include "Subsystems/InteractableRegistry.h"
+#include "Subsystems/NetDormancyManager.h"
+#include "Subsystems/InteractionScheduler.h"
+#include "Subsystems/HighlightManager.h"
+#include "SurvivalPlayerController.h"
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Interactors"), STAT_ActiveInteractors, STATGROUP_SurvivalGame);
+
+DECLARE_CYCLE_STAT(TEXT("Begin Focus"), STAT_BeginFocus, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("End Focus"), STAT_EndFocus, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Refresh Interaction Widget"), STAT_RefreshWidget, STATGROUP_SurvivalGame);
+
+int32 UInteractionComponent::NumActiveInteractors = 0;
+
 UInteractionComponent::UInteractionComponent()
 {
 	SetComponentTickEnabled(false); //component does not need to tick, optimization
@@ -12,26 +25,16 @@ UInteractionComponent::UInteractionComponent()
 	//Defaults
 	InteractionTime = 0.f;
 	InteractionDistance = 200.f; //2 Meters
+	InteractionRadius = 50.f;
 	InteractableNameText = FText::FromString("Interactable Object");
 	InteractableActionText = FText::FromString("Interact");
 	bAllowMultipleInteractors = true;
+	bDormantWhenIdle = true;
+	bInteractFailed = false;
 
-	//UI Options
-	Space = EWidgetSpace::Screen; //puts the widget in the UI space rather than world space
-	DrawSize = FIntPoint(400, 100); //size of UI element
-
-	static ConstructorHelpers::FClassFinder<UUserWidget> WBP_InteractionCard(TEXT("/Game/UserInterface/Widgets/WBP_InteractionCard"));
-	if (WBP_InteractionCard.Class != nullptr)
-	{
-		WidgetClass = WBP_InteractionCard.Class;
-	}
-
-
-	bDrawAtDesiredSize = true;
+	bWantsOnUpdateTransform = true; //registry needs to know when we move
 
 	SetActive(true);
-	SetHiddenInGame(true); //hides the menu by default so it doesn't appear always
-
 
 }
 
@@ -41,16 +44,110 @@ void UInteractionComponent::SetInteractableNameText(const FText & NewNameText)
 	RefreshWidget();
 }
 
+void UInteractionComponent::SetInteractionRadius(float NewRadius)
+{
+	InteractionRadius = FMath::Max(NewRadius, 0.f);
+
+	if (HasBegunPlay() && IsActive()) //the registry keeps its own copy
+	{
+		if (UInteractableRegistry* Registry = UInteractableRegistry::Get(this))
+		{
+			Registry->UpdateInteractable(this);
+		}
+	}
+}
+
 void UInteractionComponent::SetInteractableActionText(const FText & NewActionText)
 {
 	InteractableActionText = NewActionText;
 	RefreshWidget();
 }
 
+void UInteractionComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bDormantWhenIdle && GetOwner()->HasAuthority() && !GetOwner()->IsA<APawn>())
+	{
+		if (UNetDormancyManager* DormancyManager = UNetDormancyManager::Get(this))
+		{
+			DormancyManager->RegisterActor(GetOwner());
+		}
+	}
+
+	if (IsActive())
+	{
+		if (UInteractableRegistry* Registry = UInteractableRegistry::Get(this))
+		{
+			Registry->RegisterInteractable(this);
+		}
+	}
+}
+
+void UInteractionComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UInteractableRegistry* Registry = UInteractableRegistry::Get(this))
+	{
+		Registry->UnregisterInteractable(this);
+	}
+
+	if (UNetDormancyManager* DormancyManager = UNetDormancyManager::Get(this))
+	{
+		DormancyManager->UnregisterActor(GetOwner());
+	}
+
+	if (UHighlightManager* HighlightManager = UHighlightManager::Get(this))
+	{
+		HighlightManager->ForgetActor(GetOwner());
+	}
+
+	//nobody is interacting with something that's gone
+	UpdateActiveInteractors(-Interactors.Num());
+	Interactors.Empty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UInteractionComponent::Activate(bool bReset)
+{
+	Super::Activate(bReset);
+
+	if (IsActive() && HasBegunPlay()) //before BeginPlay the registry may not exist yet, BeginPlay handles that case
+	{
+		if (UInteractableRegistry* Registry = UInteractableRegistry::Get(this))
+		{
+			Registry->RegisterInteractable(this);
+		}
+	}
+}
+
+void UInteractionComponent::OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	Super::OnUpdateTransform(UpdateTransformFlags, Teleport);
+
+	if (HasBegunPlay() && IsActive())
+	{
+		if (UInteractableRegistry* Registry = UInteractableRegistry::Get(this))
+		{
+			Registry->UpdateInteractable(this);
+		}
+	}
+}
+
 void UInteractionComponent::Deactivate()
 {
 	Super::Deactivate();
 
+	if (UInteractableRegistry* Registry = UInteractableRegistry::Get(this)) //stop showing up in focus checks
+	{
+		Registry->UnregisterInteractable(this);
+	}
+
+	ResetInteraction();
+}
+
+void UInteractionComponent::ResetInteraction()
+{
 	for (int32 i = Interactors.Num() - 1; i >= 0; --i) //get all interactors
 	{
 		if (ASurvivalCharacter* Interactor = Interactors[i]) //stop interacting and focusing
@@ -60,7 +157,31 @@ void UInteractionComponent::Deactivate()
 		}
 	}
 
+	UpdateActiveInteractors(-Interactors.Num()); //anything EndInteract couldn't take out (destroyed characters)
 	Interactors.Empty();
+
+	//local players focusing us aren't always interacting
+	for (int32 i = LocalFocusers.Num() - 1; i >= 0; --i)
+	{
+		if (LocalFocusers.IsValidIndex(i) && LocalFocusers[i])
+		{
+			EndFocus(LocalFocusers[i]);
+		}
+	}
+
+	LocalFocusers.Empty();
+
+	//make sure no outline survives into our next use, only clients draw them
+	if (!GetOwner()->HasAuthority())
+	{
+		SetHighlight(EInteractableHighlight::None);
+	}
+}
+
+void UInteractionComponent::UpdateActiveInteractors(int32 Delta)
+{
+	NumActiveInteractors += Delta;
+	SET_DWORD_STAT(STAT_ActiveInteractors, NumActiveInteractors);
 }
 
 bool UInteractionComponent::CanInteract(ASurvivalCharacter * Character) const //enforcment
@@ -72,61 +193,92 @@ bool UInteractionComponent::CanInteract(ASurvivalCharacter * Character) const //
 
 void UInteractionComponent::RefreshWidget()
 {
-	if (!bHiddenInGame && GetOwner()->GetNetMode() != NM_DedicatedServer) //check to make sure we are not the server and action card is not hidden
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_RefreshWidget);
+
+	//only the local players looking at us have anything showing us
+	for (ASurvivalCharacter* Focuser : LocalFocusers)
 	{
-		if (UInteractionWidget* InteractionWidget = Cast<UInteractionWidget>(GetUserWidgetObject()))
+		if (APlayerController* PC = Focuser ? Cast<APlayerController>(Focuser->GetController()) : nullptr)
 		{
-			InteractionWidget->UpdateInteractionWidget(this);
+			UpdateInteractionWidget(PC);
 		}
 	}
 }
 
+void UInteractionComponent::ShowInteractionWidget(APlayerController* PC)
+{
+	if (ASurvivalPlayerController* SurvivalPC = Cast<ASurvivalPlayerController>(PC))
+	{
+		SurvivalPC->ShowInteractionCard(this);
+	}
+}
+
+void UInteractionComponent::HideInteractionWidget(APlayerController* PC)
+{
+	if (ASurvivalPlayerController* SurvivalPC = Cast<ASurvivalPlayerController>(PC))
+	{
+		SurvivalPC->HideInteractionCard(this);
+	}
+}
+
+void UInteractionComponent::UpdateInteractionWidget(APlayerController* PC)
+{
+	//only does anything if that player's card is currently showing us
+	if (ASurvivalPlayerController* SurvivalPC = Cast<ASurvivalPlayerController>(PC))
+	{
+		SurvivalPC->RefreshInteractionCard(this);
+	}
+}
+
 void UInteractionComponent::BeginFocus(ASurvivalCharacter * Character)
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_BeginFocus);
+
 	if (!IsActive() || !GetOwner() || !Character) //Character is null, do nothing
 	{
 		return;
 	}
 
-	OnBeginFocus.Broadcast(Character);
+	OnBeginFocusNative.Broadcast(Character);
+	if (OnBeginFocus.IsBound())
+	{
+		OnBeginFocus.Broadcast(Character);
+	}
 
-	SetHiddenInGame(false);
+	APlayerController* PC = Cast<APlayerController>(Character->GetController());
+	if (PC && PC->IsLocalController()) //show us to the player doing the focusing, already filled in
+	{
+		LocalFocusers.AddUnique(Character);
+		ShowInteractionWidget(PC);
+	}
 
 	if (!GetOwner()->HasAuthority()) //if not the server start outline
 	{
-		TArray<UActorComponent*> PrimitiveComponents = GetOwner()->GetComponentsByClass(UPrimitiveComponent::StaticClass());
-
-		for (auto& VisualComp : PrimitiveComponents) //LEARN MORE ABOUT LOOPS CPP
-		{
-			if (UPrimitiveComponent* Prim = Cast<UPrimitiveComponent>(VisualComp))
-			{
-				Prim->SetRenderCustomDepth(true);
-			}
-		}
-
+		SetHighlight(EInteractableHighlight::Focused);
 	}
-
-	RefreshWidget();
 }
 
 void UInteractionComponent::EndFocus(ASurvivalCharacter * Character)
 {
-	OnEndFocus.Broadcast(Character);
-
-	SetHiddenInGame(true); //hide interaction card widget
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_EndFocus);
 
-	if (!GetOwner()->HasAuthority()) //if not the server end outline
+	OnEndFocusNative.Broadcast(Character);
+	if (OnEndFocus.IsBound())
 	{
-		TArray<UActorComponent*> PrimitiveComponents = GetOwner()->GetComponentsByClass(UPrimitiveComponent::StaticClass());
+		OnEndFocus.Broadcast(Character);
+	}
 
-		for (auto& VisualComp : PrimitiveComponents) //LEARN MORE ABOUT LOOPS CPP
+	if (LocalFocusers.Remove(Character) > 0)
+	{
+		if (APlayerController* PC = Cast<APlayerController>(Character->GetController()))
 		{
-			if (UPrimitiveComponent* Prim = Cast<UPrimitiveComponent>(VisualComp))
-			{
-				Prim->SetRenderCustomDepth(false);
-			}
+			HideInteractionWidget(PC);
 		}
+	}
 
+	if (!GetOwner()->HasAuthority()) //if not the server end outline
+	{
+		SetHighlight(EInteractableHighlight::None);
 	}
 }
 
@@ -135,8 +287,23 @@ void UInteractionComponent::BeginInteract(ASurvivalCharacter * Character)
 	//if character can interact add player to list of interactors and broadcast to begin interact delegate
 	if (CanInteract(Character))
 	{
-		Interactors.AddUnique(Character);
-		OnBeginInteract.Broadcast(Character);
+		UNetDormancyManager::Wake(GetOwner()); //whatever the interaction changes needs to replicate
+		if (!Interactors.Contains(Character))
+		{
+			Interactors.Add(Character);
+			UpdateActiveInteractors(1);
+		}
+
+		OnBeginInteractNative.Broadcast(Character);
+		if (OnBeginInteract.IsBound())
+		{
+			OnBeginInteract.Broadcast(Character);
+		}
+
+		if (!GetOwner()->HasAuthority() && GetHighlight() == EInteractableHighlight::Focused) //same outline, different colour while held
+		{
+			SetHighlight(EInteractableHighlight::Interacting);
+		}
 	}
 
 }
@@ -144,32 +311,98 @@ void UInteractionComponent::BeginInteract(ASurvivalCharacter * Character)
 void UInteractionComponent::EndInteract(ASurvivalCharacter * Character)
 {
 	//remove character from list of interactors and broadcast end interact
-	Interactors.RemoveSingle(Character);
-	OnEndInteract.Broadcast(Character);
+	if (Interactors.RemoveSingle(Character) > 0)
+	{
+		UpdateActiveInteractors(-1);
+	}
+
+	OnEndInteractNative.Broadcast(Character);
+	if (OnEndInteract.IsBound())
+	{
+		OnEndInteract.Broadcast(Character);
+	}
+
+	if (GetOwner() && !GetOwner()->HasAuthority() && GetHighlight() == EInteractableHighlight::Interacting) //still focused, back to the normal outline
+	{
+		SetHighlight(EInteractableHighlight::Focused);
+	}
 
 }
 
-void UInteractionComponent::Interact(ASurvivalCharacter * Character)
+bool UInteractionComponent::Interact(ASurvivalCharacter * Character)
 {
 	if (CanInteract(Character))
 	{
-		OnInteract.Broadcast(Character);
+		UNetDormancyManager::Wake(GetOwner());
+
+		bInteractFailed = false;
+		OnInteractNative.Broadcast(Character);
+		if (OnInteract.IsBound())
+		{
+			OnInteract.Broadcast(Character);
+		}
+
+		return !bInteractFailed;
+	}
+
+	return false;
+}
+
+void UInteractionComponent::FailInteract()
+{
+	bInteractFailed = true;
+}
+
+void UInteractionComponent::RollbackInteract(ASurvivalCharacter * Character, int32 PredictionKey)
+{
+	OnInteractRolledBackNative.Broadcast(Character, PredictionKey);
+	if (OnInteractRolledBack.IsBound())
+	{
+		OnInteractRolledBack.Broadcast(Character, PredictionKey);
+	}
+}
+
+void UInteractionComponent::SetHighlight(EInteractableHighlight State)
+{
+#if !UE_SERVER //nobody to see an outline
+	UHighlightManager* HighlightManager = UHighlightManager::Get(this);
+	if (HighlightManager && GetOwner())
+	{
+		HighlightManager->SetHighlight(GetOwner(), State);
 	}
+#endif
+}
+
+EInteractableHighlight UInteractionComponent::GetHighlight() const
+{
+	const UHighlightManager* HighlightManager = UHighlightManager::Get(this);
+	return HighlightManager ? HighlightManager->GetHighlight(GetOwner()) : EInteractableHighlight::None;
 }
 
 float UInteractionComponent::GetInteractPercentage()
 {
-	if (Interactors.IsValidIndex(0)) //check if interactor is in list of valid interactors and get the first interactors (which is us bc client side)
+	ASurvivalCharacter* ShownInteractor = nullptr;
+
+	for (ASurvivalCharacter* Interactor : Interactors) //on clients this only ever holds the local player
 	{
-		if (ASurvivalCharacter* Interactor = Interactors[0])
+		if (Interactor && (!ShownInteractor || Interactor->IsLocallyControlled()))
 		{
-			if (Interactor && Interactor->IsInteracting())
+			ShownInteractor = Interactor;
+
+			if (Interactor->IsLocallyControlled())
 			{
-				return 1.f - FMath::Abs(Interactor->GetRemainingInteractTime() / InteractionTime); // 1.f - bc returns 1.X and we want 0.X
+				break;
 			}
-
 		}
 	}
 
-	return 0.f;
+	return GetInteractPercentageFor(ShownInteractor);
+}
+
+float UInteractionComponent::GetInteractPercentageFor(ASurvivalCharacter* Interactor) const
+{
+	const UInteractionScheduler* Scheduler = Interactor ? UInteractionScheduler::Get(this) : nullptr;
+
+	//session start/end times are kept by the scheduler, so this is just a subtraction
+	return Scheduler ? Scheduler->GetProgress(Interactor, this) : 0.f;
 }
@@ -3,22 +3,30 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Components/WidgetComponent.h"
+#include "Components/SceneComponent.h"
 #include "InteractionComponent.generated.h"
 
+enum class EInteractableHighlight : uint8; //Subsystems/HighlightManager.h
+
 //DELEGATES
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBeginInteract, class ASurvivalCharacter*, Character);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnEndInteract, class ASurvivalCharacter*, Character);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBeginFocus, class ASurvivalCharacter*, Character);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnEndFocus, class ASurvivalCharacter*, Character);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInteract, class ASurvivalCharacter*, Character);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnInteractRolledBack, class ASurvivalCharacter*, Character, int32, PredictionKey);
+
+//native versions for C++ listeners, no reflection on broadcast
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnInteractionEventNative, class ASurvivalCharacter*);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnInteractRolledBackNative, class ASurvivalCharacter*, int32);
 
 /**
- * 
+ * Makes its owner something players can focus and interact with. A plain scene component, nothing to render or collide with:
+ * the focused interactable is shown on the local player's shared HUD card. Use UInteractionWidgetComponent for a widget of its own
  */
 
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent)) //allows this component to be created in blueprints
-class SURVIVALGAME_API UInteractionComponent : public UWidgetComponent
+class SURVIVALGAME_API UInteractionComponent : public USceneComponent
 {
 	GENERATED_BODY()
 	
@@ -34,6 +42,11 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
 		float InteractionDistance;
 
+	//How far from its center the object can be focused, so big objects work from their edges. Set by hand rather than
+	//read from mesh bounds, which aren't there on a dedicated server, so the client's focus check and the server's validation agree
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction", meta = (ClampMin = 0.0))
+		float InteractionRadius;
+
 	//The name that will appear when the player looks at the object
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
 		FText InteractableNameText;
@@ -46,9 +59,16 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
 		bool bAllowMultipleInteractors;
 
+	//Keep the owner net dormant while nobody is using it, interacting wakes it up again. Ignored for pawns
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+		bool bDormantWhenIdle;
+
 	UFUNCTION(BlueprintCallable, Category = "Interaction")
 	void SetInteractableNameText(const FText& NewNameText);
 
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	void SetInteractionRadius(float NewRadius);
+
 	UFUNCTION(BlueprintCallable, Category = "Interaction")
 	void SetInteractableActionText(const FText& NewActionText);
 
@@ -69,12 +89,35 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintAssignable)
 	FOnInteract OnInteract;
 
+	//[local] the server refused an instant interaction this client predicted, undo whatever OnInteract did locally for that key
+	UPROPERTY(EditDefaultsOnly, BlueprintAssignable)
+	FOnInteractRolledBack OnInteractRolledBack;
+
+	//C++ code should bind these instead, they fire right before the Blueprint delegates above
+	//the Blueprint ones are only broadcast when something is bound to them
+	FOnInteractionEventNative OnBeginInteractNative;
+	FOnInteractionEventNative OnEndInteractNative;
+	FOnInteractionEventNative OnBeginFocusNative;
+	FOnInteractionEventNative OnEndFocusNative;
+	FOnInteractionEventNative OnInteractNative;
+	FOnInteractRolledBackNative OnInteractRolledBackNative;
+
+	//[server] Call from an OnInteract handler when the interaction couldn't actually happen (inventory full etc) so a predicting client rolls back
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	void FailInteract();
+
 
 protected:
 
-	//Called when game starts
+	//Register/unregister with the interactable registry so the focus check can find us without a trace
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Activate(bool bReset = false) override;
 	virtual void Deactivate() override;
 
+	//Keeps our registry cell up to date if the owner moves
+	virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport = ETeleportType::None) override;
+
 	//which characters can interact with interactable objs
 	bool CanInteract(class ASurvivalCharacter* Character) const;
 	
@@ -83,6 +126,27 @@ protected:
 	UPROPERTY()
 	TArray<class ASurvivalCharacter*> Interactors;
 
+	//[local] locally controlled characters focusing us, more than one in split screen. Widget updates go to their controllers
+	UPROPERTY()
+	TArray<class ASurvivalCharacter*> LocalFocusers;
+
+	//[local] Show/hide/update us for a local player that focuses us, by default on that player's shared HUD card
+	virtual void ShowInteractionWidget(class APlayerController* PC);
+	virtual void HideInteractionWidget(class APlayerController* PC);
+	virtual void UpdateInteractionWidget(class APlayerController* PC);
+
+	//every interactor of every interaction component, for 'stat SurvivalGame' and the CSV profiler
+	static int32 NumActiveInteractors;
+
+	static void UpdateActiveInteractors(int32 Delta);
+
+	//set by FailInteract during the OnInteract broadcast
+	bool bInteractFailed;
+
+	//Outline our owner through the highlight manager, applied with everything else at the end of the frame
+	void SetHighlight(EInteractableHighlight State);
+	EInteractableHighlight GetHighlight() const;
+
 public:
 
 	//Refresh interaction widget ONLY when something is changed - OPTIMIZATION
@@ -96,11 +160,23 @@ public:
 	void BeginInteract(class ASurvivalCharacter* Character);
 	void EndInteract(class ASurvivalCharacter* Character);
 
-	void Interact(class ASurvivalCharacter* Character);
+	//false if the interaction was refused, or a handler called FailInteract
+	bool Interact(class ASurvivalCharacter* Character);
+
+	//[local] Undo a predicted interaction the server rejected
+	void RollbackInteract(class ASurvivalCharacter* Character, int32 PredictionKey);
+
+	//Drop every interactor and focus and clear any outline we left on, used when a pooled owner is recycled
+	void ResetInteraction();
 
 	//returns value between 0-1 that represents progress through interaction
-	//Serverside = first interactors %
-	//Clientside = local interactors %
+	//Prefers a locally controlled interactor, so a listen server host sees its own progress rather than whoever started first
 	UFUNCTION(BlueprintPure, Category = "Interaction")
 	float GetInteractPercentage();
+
+	//Progress of one particular interactor, each one has its own when bAllowMultipleInteractors is set
+	UFUNCTION(BlueprintPure, Category = "Interaction")
+	float GetInteractPercentageFor(class ASurvivalCharacter* Interactor) const;
+
+	FORCEINLINE static int32 GetNumActiveInteractors() { return NumActiveInteractors; }
 };
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractionWidgetComponent.h"
+#include "Components/WidgetComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Widgets/InteractionWidget.h"
+#include "Subsystems/AssetStreamingManager.h"
+
+UInteractionWidgetComponent::UInteractionWidgetComponent()
+{
+	InteractionWidgetClass = FSoftClassPath(TEXT("/Game/UserInterface/Widgets/WBP_InteractionCard.WBP_InteractionCard_C"));
+	WidgetDrawSize = FIntPoint(400, 100);
+
+	WidgetComponent = nullptr;
+}
+
+void UInteractionWidgetComponent::ShowInteractionWidget(APlayerController* PC)
+{
+#if !UE_SERVER //no widgets in server builds
+	WidgetPlayer = PC;
+
+	if (!WidgetComponent && !CreateWidgetComponent()) //shown once the class has loaded
+	{
+		return;
+	}
+
+	WidgetComponent->SetOwnerPlayer(PC->GetLocalPlayer()); //only the player focusing us sees it in split screen
+	WidgetComponent->SetHiddenInGame(false);
+	UpdateInteractionWidget(PC);
+#endif
+}
+
+void UInteractionWidgetComponent::HideInteractionWidget(APlayerController* PC)
+{
+	if (WidgetPlayer != PC) //another local player has taken the widget over
+	{
+		return;
+	}
+
+	WidgetPlayer = nullptr;
+
+	if (WidgetComponent)
+	{
+		WidgetComponent->SetHiddenInGame(true);
+	}
+}
+
+void UInteractionWidgetComponent::UpdateInteractionWidget(APlayerController* PC)
+{
+	if (WidgetComponent && WidgetPlayer == PC)
+	{
+		if (UInteractionWidget* InteractionWidget = Cast<UInteractionWidget>(WidgetComponent->GetUserWidgetObject()))
+		{
+			InteractionWidget->UpdateInteractionWidget(this);
+		}
+	}
+}
+
+bool UInteractionWidgetComponent::CreateWidgetComponent()
+{
+	UClass* WidgetClass = InteractionWidgetClass.Get();
+
+	if (!WidgetClass)
+	{
+		if (UAssetStreamingManager* Streaming = UAssetStreamingManager::Get(this))
+		{
+			Streaming->RequestAsset(InteractionWidgetClass.ToSoftObjectPath(), EAssetStreamingPriority::High, FSimpleDelegate::CreateUObject(this, &UInteractionWidgetComponent::OnInteractionWidgetClassLoaded));
+		}
+
+		return false;
+	}
+
+	WidgetComponent = NewObject<UWidgetComponent>(GetOwner(), NAME_None, RF_Transient);
+	WidgetComponent->SetWidgetSpace(EWidgetSpace::Screen); //puts the widget in the UI space rather than world space
+	WidgetComponent->SetDrawSize(FVector2D(WidgetDrawSize));
+	WidgetComponent->SetDrawAtDesiredSize(true);
+	WidgetComponent->SetWidgetClass(WidgetClass);
+
+	//only there to draw, nothing to collide with
+	WidgetComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	WidgetComponent->SetGenerateOverlapEvents(false);
+	WidgetComponent->SetCanEverAffectNavigation(false);
+	WidgetComponent->SetHiddenInGame(true);
+
+	WidgetComponent->SetupAttachment(this);
+	WidgetComponent->RegisterComponent();
+
+	return true;
+}
+
+void UInteractionWidgetComponent::OnInteractionWidgetClassLoaded()
+{
+	//still focused by whoever asked for it
+	if (IsRegistered() && WidgetPlayer.IsValid() && !WidgetComponent)
+	{
+		ShowInteractionWidget(WidgetPlayer.Get());
+	}
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InteractionComponent.h"
+#include "InteractionWidgetComponent.generated.h"
+
+/**
+ * An interaction component that shows its own widget instead of the local player's shared HUD card.
+ * Only for interactables that really need a custom widget: the widget component is created the first time
+ * a local player focuses us (never on a dedicated server) and reused after that.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API UInteractionWidgetComponent : public UInteractionComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UInteractionWidgetComponent();
+
+	//Widget to show while focused. Streamed in the first time it is needed rather than loaded with every interactable class
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Widget")
+	TSoftClassPtr<class UInteractionWidget> InteractionWidgetClass;
+
+	//size of UI element
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Widget")
+	FIntPoint WidgetDrawSize;
+
+protected:
+
+	virtual void ShowInteractionWidget(class APlayerController* PC) override;
+	virtual void HideInteractionWidget(class APlayerController* PC) override;
+	virtual void UpdateInteractionWidget(class APlayerController* PC) override;
+
+	//false if the widget class isn't loaded yet, it is requested and the widget shown once it is
+	bool CreateWidgetComponent();
+	void OnInteractionWidgetClassLoaded();
+
+	UPROPERTY(Transient)
+	class UWidgetComponent* WidgetComponent;
+
+	//the local player the widget is showing for, one at a time
+	TWeakObjectPtr<class APlayerController> WidgetPlayer;
+
+};
@@ -2,33 +2,929 @@
 
 
 #include "InventoryComponent.h"
+#include "Items/Item.h"
+#include "Items/ItemDefinition.h"
+#include "Subsystems/PickupPool.h"
+#include "Subsystems/NetDormancyManager.h"
+#include "Subsystems/AssetStreamingManager.h"
+#include "Subsystems/ItemRegistry.h"
+#include "Net/UnrealNetwork.h"
+#include "Engine/ActorChannel.h"
+#include "Engine/NetConnection.h"
+#include "Engine/ChildConnection.h"
+#include "Engine/PackageMapClient.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "SurvivalGame.h"
+
+DECLARE_CYCLE_STAT(TEXT("Inventory Add Item"), STAT_InventoryAddItem, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Inventory Remove Item"), STAT_InventoryRemoveItem, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Inventory Transaction"), STAT_InventoryTransaction, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Inventory Transfer"), STAT_InventoryTransfer, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Inventory Updated Broadcast"), STAT_InventoryUpdatedBroadcast, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Inventory Replicate Subobjects"), STAT_InventoryReplicateSubobjects, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Inventory Entry Replicated"), STAT_InventoryEntryReplicated, STATGROUP_SurvivalGame);
+
+bool FInventoryItemStack::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	UItemRegistry::NetSerializeDefinition(Ar, Map, Definition);
+
+	uint32 PackedQuantity = (uint32)FMath::Max(Quantity, 0);
+	Ar.SerializeIntPacked(PackedQuantity);
+
+	if (Ar.IsLoading())
+	{
+		Quantity = (int32)PackedQuantity;
+	}
+
+	bOutSuccess = true;
+	return true;
+}
+
+void FInventoryEntry::PreReplicatedRemove(const FInventoryList& InArraySerializer)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryEntryReplicated);
+
+	if (Item && Item->OwningInventory == InArraySerializer.OwnerComponent)
+	{
+		Item->OwningInventory = nullptr;
+	}
+
+	if (UInventoryComponent* Inventory = InArraySerializer.OwnerComponent)
+	{
+		Inventory->RemoveFromAggregates(*this);
+		Inventory->NotifyReplicatedUpdate();
+	}
+}
+
+void FInventoryEntry::PostReplicatedAdd(const FInventoryList& InArraySerializer)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryEntryReplicated);
+
+	if (Item) //may still be unresolved if the subobject hasn't arrived, PostReplicatedChange picks it up once it does
+	{
+		Item->OwningInventory = InArraySerializer.OwnerComponent;
+		Item->Quantity = Quantity;
+	}
+
+	if (UInventoryComponent* Inventory = InArraySerializer.OwnerComponent)
+	{
+		Inventory->MatchArrivedEntry(*this);
+		Inventory->UpdateAggregates(*this);
+		Inventory->NotifyReplicatedUpdate();
+	}
+}
+
+void FInventoryEntry::PostReplicatedChange(const FInventoryList& InArraySerializer)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryEntryReplicated);
+
+	if (Item)
+	{
+		Item->OwningInventory = InArraySerializer.OwnerComponent;
+		Item->Quantity = Quantity;
+		Item->BroadcastItemModified();
+	}
+
+	if (UInventoryComponent* Inventory = InArraySerializer.OwnerComponent)
+	{
+		Inventory->MatchArrivedEntry(*this);
+		Inventory->UpdateAggregates(*this);
+		Inventory->NotifyReplicatedUpdate();
+	}
+}
+
+bool FInventoryList::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	//only real connections are filtered, a package map without one has nobody to hide the contents from
+	const UPackageMapClient* PackageMap = Cast<UPackageMapClient>(DeltaParms.Map);
+
+	if (DeltaParms.Writer && PackageMap && OwnerComponent && !OwnerComponent->ShouldReplicateTo(PackageMap->GetConnection()))
+	{
+		return false;
+	}
+
+	return FFastArraySerializer::FastArrayDeltaSerialize<FInventoryEntry, FInventoryList>(Entries, DeltaParms, *this);
+}
 
 // Sets default values for this component's properties
 UInventoryComponent::UInventoryComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bCanEverTick = false; //everything happens on add/remove/change, nothing to tick
+
+	SetIsReplicated(true);
+
+	Items.OwnerComponent = this;
+	ReplicatedItemsKey = 0;
+
+	Capacity = 0;
+	WeightCapacity = 0.f;
+	bReplicateToOwnerOnly = false;
+	CurrentWeight = 0.0;
+
+	BatchDepth = 0;
+	bBatchModified = false;
+	bReplicatedUpdatePending = false;
+
+	ConfirmedPredictionTimeout = 1.f;
+}
+
+void UInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	//owner only is decided per inventory, conditions are per class. See PreReplication and FInventoryList::NetDeltaSerialize
+	DOREPLIFETIME_CONDITION(UInventoryComponent, Items, COND_Custom);
+}
+
+void UInventoryComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	//an owner only inventory without an owning player (a bot's) has nobody to go to, don't even compare it
+	const bool bHasRecipient = !bReplicateToOwnerOnly || (GetOwner() && GetOwner()->GetNetConnection());
+	DOREPLIFETIME_ACTIVE_OVERRIDE(UInventoryComponent, Items, bHasRecipient);
+}
+
+bool UInventoryComponent::ShouldReplicateTo(const UNetConnection* Connection) const
+{
+	if (!bReplicateToOwnerOnly)
+	{
+		return true;
+	}
+
+	//everyone else would just be paying for it (and could read it)
+	UNetConnection* OwnerConnection = GetOwner() ? GetOwner()->GetNetConnection() : nullptr;
+
+	if (UChildConnection* ChildConnection = OwnerConnection ? OwnerConnection->GetUChildConnection() : nullptr) //split screen players are sent through their parent
+	{
+		OwnerConnection = ChildConnection->Parent;
+	}
+
+	return OwnerConnection && OwnerConnection == Connection;
+}
+
+bool UInventoryComponent::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryReplicateSubobjects);
+
+	bool bWroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
+
+	//an owner only inventory's items go to the owner only, like the list that refers to them
+	if (bReplicateToOwnerOnly && !RepFlags->bNetOwner)
+	{
+		return bWroteSomething;
+	}
+
+	//nothing changed since this channel last looked, don't even walk the items
+	if (Channel->KeyNeedsToReplicate(GetUniqueID(), ReplicatedItemsKey))
+	{
+		for (const FInventoryEntry& Entry : Items.Entries)
+		{
+			//only compare an item's properties if its RepKey moved
+			if (Entry.Item && Channel->KeyNeedsToReplicate(Entry.Item->GetUniqueID(), Entry.Item->RepKey))
+			{
+				Entry.Item->MarkReplicated();
+				bWroteSomething |= Channel->ReplicateSubobject(Entry.Item, *Bunch, *RepFlags);
+			}
+		}
+	}
+
+	return bWroteSomething;
+}
+
+UItem* UInventoryComponent::AddItemFromDefinition(UItemDefinition* Definition, const int32 Quantity)
+{
+	if (!Definition || Quantity <= 0 || !GetOwner() || !GetOwner()->HasAuthority())
+	{
+		return nullptr;
+	}
+
+	//one item is one stack, clamping would silently throw the rest away. ApplyTransaction splits bigger amounts into stacks
+	if (Quantity > Definition->GetMaxQuantity())
+	{
+		UE_LOG(LogSurvivalGame, Warning, TEXT("AddItemFromDefinition: %d %s won't fit in one stack of %d, use ApplyTransaction"), Quantity, *Definition->GetName(), Definition->GetMaxQuantity());
+		return nullptr;
+	}
+
+	//check limits before creating anything so a full inventory doesn't leave garbage items behind
+	if (!CanFit(1, (double)Definition->Weight * Quantity))
+	{
+		return nullptr;
+	}
+
+	return AddNewStack(Definition, Quantity);
+}
+
+UItem* UInventoryComponent::AddItem(UItem* Item)
+{
+	if (!Item || !GetOwner() || !GetOwner()->HasAuthority() || FindEntry(Item))
+	{
+		return nullptr;
+	}
+
+	if (!CanFit(1, (double)Item->GetStackWeight())) //no room
+	{
+		return nullptr;
+	}
+
+	return AddItemUnchecked(Item);
+}
+
+UItem* UInventoryComponent::AddNewStack(UItemDefinition* Definition, int32 Quantity)
+{
+	//outer has to be the owning actor for subobject replication
+	UPickupPool* Pool = UPickupPool::Get(this);
+	UItem* NewItem = Pool ? Pool->AcquireItem(GetOwner(), Definition, Quantity) : NewObject<UItem>(GetOwner());
+	NewItem->Definition = Definition;
+	NewItem->Quantity = Quantity;
+
+	return AddItemUnchecked(NewItem);
+}
+
+UItem* UInventoryComponent::AddItemUnchecked(UItem* Item)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryAddItem);
+
+	if (Item->OwningInventory) //can only be in one inventory at a time
+	{
+		Item->OwningInventory->RemoveItem(Item);
+	}
+
+	if (Item->GetOuter() != GetOwner())
+	{
+		if (Item->HasReplicated()) //clients know it by a NetGUID under its old actor's channel, it can't move to ours
+		{
+			Item = DuplicateObject<UItem>(Item, GetOwner());
+		}
+		else
+		{
+			Item->Rename(nullptr, GetOwner());
+		}
+	}
+
+	Item->OwningInventory = this;
+	Item->MarkDirtyForReplication(); //new to this actor's channels, needs to replicate once
+
+	FInventoryEntry& NewEntry = Items.Entries.AddDefaulted_GetRef();
+	NewEntry.Item = Item;
+	NewEntry.Quantity = Item->Quantity;
+	Items.MarkItemDirty(NewEntry);
+	++ReplicatedItemsKey;
+	UpdateAggregates(NewEntry);
+
+	Item->AddedToInventory(this);
+	NotifyInventoryUpdated();
+
+	return Item;
+}
+
+bool UInventoryComponent::RemoveItem(UItem* Item)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryRemoveItem);
+
+	if (!Item || !GetOwner() || !GetOwner()->HasAuthority())
+	{
+		return false;
+	}
+
+	const int32 Index = Items.Entries.IndexOfByPredicate([Item](const FInventoryEntry& Entry) { return Entry.Item == Item; });
+
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	RemoveFromAggregates(Items.Entries[Index]);
+	Items.Entries.RemoveAt(Index);
+	Items.MarkArrayDirty();
+	++ReplicatedItemsKey;
+
+	Item->OwningInventory = nullptr;
+	NotifyInventoryUpdated();
+
+	return true;
+}
+
+TArray<UItem*> UInventoryComponent::GetItems() const
+{
+	TArray<UItem*> OutItems;
+	OutItems.Reserve(Items.Entries.Num());
+
+	for (const FInventoryEntry& Entry : Items.Entries)
+	{
+		if (Entry.Item)
+		{
+			OutItems.Add(Entry.Item);
+		}
+	}
+
+	for (const FPredictedInventoryItem& Predicted : PredictedItems)
+	{
+		OutItems.Add(Predicted.Item);
+	}
+
+	return OutItems;
+}
+
+void UInventoryComponent::LoadThumbnails()
+{
+	UAssetStreamingManager* Streaming = UAssetStreamingManager::Get(this);
+	if (!Streaming)
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> Paths;
+	bool bAllLoaded = true;
+
+	for (const UItem* Item : GetItems())
+	{
+		if (const UItemDefinition* Definition = Item ? Item->Definition : nullptr)
+		{
+			Paths.AddUnique(Definition->Thumbnail.ToSoftObjectPath());
+			Paths.AddUnique(Definition->ItemTooltip.ToSoftObjectPath());
+
+			bAllLoaded &= Definition->Thumbnail.IsNull() || Definition->Thumbnail.IsValid();
+			bAllLoaded &= Definition->ItemTooltip.IsNull() || Definition->ItemTooltip.IsValid();
+		}
+	}
+
+	//still requested so the cache counts them as recently used, but the UI already has everything so no update
+	FSimpleDelegate OnLoaded = bAllLoaded ? FSimpleDelegate() : FSimpleDelegate::CreateUObject(this, &UInventoryComponent::BroadcastInventoryUpdated);
+	Streaming->RequestAssets(Paths, EAssetStreamingPriority::Normal, OnLoaded);
+}
+
+UItem* UInventoryComponent::FindItemByDefinition(const UItemDefinition* Definition) const
+{
+	for (const FInventoryEntry& Entry : Items.Entries)
+	{
+		if (Entry.Item && Entry.Item->Definition == Definition)
+		{
+			return Entry.Item;
+		}
+	}
+
+	return nullptr;
+}
+
+void UInventoryComponent::MarkItemDirty(UItem* Item)
+{
+	if (FInventoryEntry* Entry = FindEntry(Item))
+	{
+		if (Entry->Quantity != Item->Quantity)
+		{
+			Entry->Quantity = Item->Quantity;
+			Items.MarkItemDirty(*Entry);
+			UpdateAggregates(*Entry);
+		}
+
+		++ReplicatedItemsKey;
+
+		//clients get these from PostReplicatedChange, the server has to fire them itself
+		//inside a batch only the single inventory-wide event goes out at the end
+		if (BatchDepth == 0)
+		{
+			Item->BroadcastItemModified();
+		}
+
+		NotifyInventoryUpdated();
+	}
+}
+
+void UInventoryComponent::OnItemDefinitionReplicated(UItem* Item)
+{
+	if (FInventoryEntry* Entry = FindEntry(Item))
+	{
+		MatchArrivedEntry(*Entry); //couldn't be matched when the entry arrived without its definition
+		UpdateAggregates(*Entry);
+		NotifyReplicatedUpdate();
+	}
+}
+
+FInventoryEntry* UInventoryComponent::FindEntry(const UItem* Item)
+{
+	return Items.Entries.FindByPredicate([Item](const FInventoryEntry& Entry) { return Entry.Item == Item; });
+}
+
+int32 UInventoryComponent::GetItemCount(const UItemDefinition* Definition) const
+{
+	const int32* Count = ItemCounts.Find(Definition);
+	return Count ? *Count : 0;
+}
+
+int32 UInventoryComponent::GetRemainingCapacity() const
+{
+	return Capacity > 0 ? FMath::Max(Capacity - Items.Entries.Num(), 0) : MAX_int32;
+}
+
+float UInventoryComponent::GetRemainingWeightCapacity() const
+{
+	return WeightCapacity > 0.f ? FMath::Max(WeightCapacity - GetCurrentWeight(), 0.f) : MAX_FLT;
+}
+
+void UInventoryComponent::UpdateAggregates(FInventoryEntry& Entry)
+{
+	const UItemDefinition* Definition = Entry.Item ? Entry.Item->Definition : nullptr;
+	const int32 Quantity = Definition ? Entry.Quantity : 0; //unresolved items on clients count once they arrive
+
+	if (Definition == Entry.AccountedDefinition && Quantity == Entry.AccountedQuantity)
+	{
+		return;
+	}
+
+	ApplyAggregateDelta(Entry.AccountedDefinition, -Entry.AccountedQuantity);
+	ApplyAggregateDelta(Definition, Quantity);
+
+	Entry.AccountedDefinition = Definition;
+	Entry.AccountedQuantity = Quantity;
+}
+
+void UInventoryComponent::RemoveFromAggregates(FInventoryEntry& Entry)
+{
+	ApplyAggregateDelta(Entry.AccountedDefinition, -Entry.AccountedQuantity);
 
-	// ...
+	Entry.AccountedDefinition = nullptr;
+	Entry.AccountedQuantity = 0;
 }
 
+void UInventoryComponent::ApplyAggregateDelta(const UItemDefinition* Definition, int32 QuantityDelta)
+{
+	if (!Definition || QuantityDelta == 0)
+	{
+		return;
+	}
 
-// Called when the game starts
-void UInventoryComponent::BeginPlay()
+	CurrentWeight = FMath::Max(CurrentWeight + (double)Definition->Weight * QuantityDelta, 0.0);
+
+	int32& Count = ItemCounts.FindOrAdd(Definition);
+	Count += QuantityDelta;
+
+	if (Count <= 0)
+	{
+		ItemCounts.Remove(Definition);
+
+		if (ItemCounts.Num() == 0) //empty, wipe any rounding error that built up
+		{
+			CurrentWeight = 0.0;
+		}
+	}
+}
+
+bool UInventoryComponent::ApplyTransaction(const FInventoryTransaction& Transaction)
 {
-	Super::BeginPlay();
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryTransaction);
+
+	if (!GetOwner() || !GetOwner()->HasAuthority())
+	{
+		return false;
+	}
 
-	// ...
-	
+	FInventoryTransactionPlan Plan;
+	if (!PlanTransaction(Transaction, Plan))
+	{
+		return false;
+	}
+
+	CommitTransactionPlan(Plan);
+	return true;
 }
 
+bool UInventoryComponent::TransferItems(UInventoryComponent* Target, const TArray<FInventoryItemStack>& Stacks)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryTransfer);
+
+	if (!Target || Target == this || !GetOwner() || !GetOwner()->HasAuthority())
+	{
+		return false;
+	}
+
+	FInventoryTransaction RemoveFromUs;
+	RemoveFromUs.ItemsToRemove = Stacks;
+
+	FInventoryTransaction AddToTarget;
+	AddToTarget.ItemsToAdd = Stacks;
+
+	//both sides have to work before either is touched
+	FInventoryTransactionPlan OurPlan;
+	FInventoryTransactionPlan TargetPlan;
 
-// Called every frame
-void UInventoryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+	if (!PlanTransaction(RemoveFromUs, OurPlan) || !Target->PlanTransaction(AddToTarget, TargetPlan))
+	{
+		return false;
+	}
+
+	CommitTransactionPlan(OurPlan);
+	Target->CommitTransactionPlan(TargetPlan);
+	return true;
+}
+
+bool UInventoryComponent::TransferAllItems(UInventoryComponent* Target)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryTransfer);
+
+	TArray<FInventoryItemStack> Stacks;
+	Stacks.Reserve(ItemCounts.Num());
 
-	// ...
+	for (const TPair<const UItemDefinition*, int32>& Count : ItemCounts) //aggregates already have one total per item type
+	{
+		Stacks.Emplace(const_cast<UItemDefinition*>(Count.Key), Count.Value);
+	}
+
+	return Stacks.Num() > 0 && TransferItems(Target, Stacks);
 }
 
+bool UInventoryComponent::PlanTransaction(const FInventoryTransaction& Transaction, FInventoryTransactionPlan& OutPlan) const
+{
+	//quantity each existing stack would end up with
+	auto GetPlannedQuantity = [&OutPlan](UItem* Item) -> int32&
+	{
+		if (int32* Planned = OutPlan.NewQuantities.Find(Item))
+		{
+			return *Planned;
+		}
+
+		return OutPlan.NewQuantities.Add(Item, Item->Quantity);
+	};
+
+	//Removes first so they free up room for the adds. Take from the last stacks first, they're usually the partial ones
+	for (const FInventoryItemStack& Remove : Transaction.ItemsToRemove)
+	{
+		if (!Remove.Definition || Remove.Quantity <= 0)
+		{
+			continue;
+		}
+
+		int32 Remaining = Remove.Quantity;
+
+		for (int32 i = Items.Entries.Num() - 1; i >= 0 && Remaining > 0; --i)
+		{
+			UItem* Item = Items.Entries[i].Item;
+
+			if (Item && Item->Definition == Remove.Definition)
+			{
+				int32& Planned = GetPlannedQuantity(Item);
+				const int32 Taken = FMath::Min(Planned, Remaining);
+
+				if (Taken > 0 && Planned == Taken)
+				{
+					--OutPlan.StackDelta; //stack emptied
+				}
+
+				Planned -= Taken;
+				Remaining -= Taken;
+			}
+		}
+
+		if (Remaining > 0) //don't have enough
+		{
+			return false;
+		}
+
+		OutPlan.WeightDelta -= (double)Remove.Definition->Weight * Remove.Quantity;
+	}
+
+	for (const FInventoryItemStack& Add : Transaction.ItemsToAdd)
+	{
+		if (!Add.Definition || Add.Quantity <= 0)
+		{
+			continue;
+		}
+
+		const int32 MaxQuantity = Add.Definition->GetMaxQuantity();
+		int32 Remaining = Add.Quantity;
+
+		//top up partial stacks we already have
+		if (Add.Definition->bCanStack)
+		{
+			for (int32 i = 0; i < Items.Entries.Num() && Remaining > 0; ++i)
+			{
+				UItem* Item = Items.Entries[i].Item;
+
+				if (Item && Item->Definition == Add.Definition)
+				{
+					int32& Planned = GetPlannedQuantity(Item);
+
+					if (Planned > 0) //don't refill a stack this transaction is emptying, it's being removed
+					{
+						const int32 Added = FMath::Min(MaxQuantity - Planned, Remaining);
+						Planned += FMath::Max(Added, 0);
+						Remaining -= FMath::Max(Added, 0);
+					}
+				}
+			}
+
+			//and partial stacks this transaction is creating
+			for (FInventoryItemStack& NewStack : OutPlan.NewStacks)
+			{
+				if (NewStack.Definition == Add.Definition && Remaining > 0)
+				{
+					const int32 Added = FMath::Min(MaxQuantity - NewStack.Quantity, Remaining);
+					NewStack.Quantity += Added;
+					Remaining -= Added;
+				}
+			}
+		}
+
+		//whatever is left needs new stacks
+		while (Remaining > 0)
+		{
+			const int32 StackQuantity = FMath::Min(MaxQuantity, Remaining);
+			OutPlan.NewStacks.Emplace(Add.Definition, StackQuantity);
+			++OutPlan.StackDelta;
+			Remaining -= StackQuantity;
+		}
+
+		OutPlan.WeightDelta += (double)Add.Definition->Weight * Add.Quantity;
+	}
+
+	//limits are checked against the end result, a transaction that removes as much as it adds always fits
+	return CanFit(OutPlan.StackDelta, OutPlan.WeightDelta);
+}
+
+bool UInventoryComponent::CanFit(int32 StackDelta, double WeightDelta) const
+{
+	if (Capacity > 0 && Items.Entries.Num() + StackDelta > Capacity)
+	{
+		return false;
+	}
+
+	//a little slack so rounding in the cached weight can't refuse an exact fit
+	if (WeightCapacity > 0.f && CurrentWeight + WeightDelta > WeightCapacity + KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void UInventoryComponent::CommitTransactionPlan(const FInventoryTransactionPlan& Plan)
+{
+	BeginBatch();
+
+	//changes to existing stacks first, emptied stacks free up their slots before new ones are made
+	for (const TPair<UItem*, int32>& NewQuantity : Plan.NewQuantities)
+	{
+		if (NewQuantity.Value <= 0)
+		{
+			RemoveItem(NewQuantity.Key);
+
+			if (UPickupPool* Pool = UPickupPool::Get(this)) //used up, nothing else holds on to it
+			{
+				Pool->ReleaseItem(NewQuantity.Key);
+			}
+		}
+		else
+		{
+			NewQuantity.Key->SetQuantity(NewQuantity.Value);
+		}
+	}
+
+	//the plan already checked the limits against the end result, checking each stack again could refuse one halfway through
+	for (const FInventoryItemStack& NewStack : Plan.NewStacks)
+	{
+		AddNewStack(NewStack.Definition, NewStack.Quantity);
+	}
+
+	EndBatch();
+}
+
+void UInventoryComponent::BeginBatch()
+{
+	++BatchDepth;
+}
+
+void UInventoryComponent::EndBatch()
+{
+	if (--BatchDepth > 0 || !bBatchModified)
+	{
+		return;
+	}
+
+	bBatchModified = false;
+	BroadcastInventoryUpdated();
+
+	if (GetOwner())
+	{
+		GetOwner()->ForceNetUpdate(); //everything that changed goes out together in the next update
+	}
+}
+
+void UInventoryComponent::NotifyInventoryUpdated()
+{
+	UNetDormancyManager::Wake(GetOwner()); //a container sitting dormant has to send the change
+	if (BatchDepth > 0)
+	{
+		bBatchModified = true;
+		return;
+	}
+
+	BroadcastInventoryUpdated();
+}
+
+void UInventoryComponent::BroadcastInventoryUpdated()
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryUpdatedBroadcast);
+
+	OnInventoryUpdatedNative.Broadcast();
+
+	if (OnInventoryUpdated.IsBound())
+	{
+		OnInventoryUpdated.Broadcast();
+	}
+}
+
+void UInventoryComponent::NotifyReplicatedUpdate()
+{
+	if (bReplicatedUpdatePending || !GetWorld())
+	{
+		return;
+	}
+
+	bReplicatedUpdatePending = true;
+	GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UInventoryComponent::BroadcastReplicatedUpdate);
+}
+
+void UInventoryComponent::BroadcastReplicatedUpdate()
+{
+	bReplicatedUpdatePending = false;
+
+	BroadcastInventoryUpdated();
+}
+
+void UInventoryComponent::AddPredictedItem(int32 PredictionKey, UItemDefinition* Definition, int32 Quantity)
+{
+	if (!Definition || Quantity <= 0 || GetOwnerRole() == ROLE_Authority)
+	{
+		return;
+	}
+
+	UItem* PredictedItem = NewObject<UItem>(this);
+	PredictedItem->Definition = Definition;
+	PredictedItem->Quantity = FMath::Clamp(Quantity, 1, Definition->GetMaxQuantity());
+
+	FPredictedInventoryItem& NewPrediction = PredictedItems.AddDefaulted_GetRef();
+	NewPrediction.PredictionKey = PredictionKey;
+	NewPrediction.Item = PredictedItem;
+
+	ApplyAggregateDelta(Definition, PredictedItem->Quantity);
+	BroadcastInventoryUpdated();
+}
+
+void UInventoryComponent::ConfirmPrediction(int32 PredictionKey)
+{
+	const float Now = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.f;
+	const int32 NumBefore = PredictedItems.Num();
+
+	for (int32 i = PredictedItems.Num() - 1; i >= 0; --i)
+	{
+		FPredictedInventoryItem& Predicted = PredictedItems[i];
+
+		if (Predicted.PredictionKey != PredictionKey)
+		{
+			continue;
+		}
+
+		//the real item beat the server's answer here, nothing left to wait for
+		if (Predicted.Item && Predicted.ArrivedQuantity >= Predicted.Item->Quantity)
+		{
+			RemovePredictedItemAt(i);
+			continue;
+		}
+
+		Predicted.bConfirmed = true;
+		Predicted.DropDeadline = Now + ConfirmedPredictionTimeout;
+	}
+
+	if (PredictedItems.Num() != NumBefore)
+	{
+		NotifyReplicatedUpdate();
+	}
+
+	ScheduleNextPredictionDeadline();
+}
+
+void UInventoryComponent::RejectPrediction(int32 PredictionKey)
+{
+	const int32 NumBefore = PredictedItems.Num();
+
+	for (int32 i = PredictedItems.Num() - 1; i >= 0; --i)
+	{
+		if (PredictedItems[i].PredictionKey == PredictionKey)
+		{
+			RemovePredictedItemAt(i);
+		}
+	}
+
+	if (PredictedItems.Num() != NumBefore)
+	{
+		BroadcastInventoryUpdated();
+	}
+}
+
+void UInventoryComponent::MatchArrivedEntry(const FInventoryEntry& Entry)
+{
+	if (PredictedItems.Num() == 0)
+	{
+		return;
+	}
+
+	const UItemDefinition* Definition = Entry.Item ? Entry.Item->Definition : nullptr;
+	const int32 Gained = Definition == Entry.AccountedDefinition ? Entry.Quantity - Entry.AccountedQuantity : Entry.Quantity;
+
+	if (Definition && Gained > 0)
+	{
+		MatchArrivedQuantity(Definition, Gained);
+	}
+}
+
+void UInventoryComponent::MatchArrivedQuantity(const UItemDefinition* Definition, int32 Quantity)
+{
+	for (int32 i = 0; i < PredictedItems.Num() && Quantity > 0; )
+	{
+		FPredictedInventoryItem& Predicted = PredictedItems[i];
+
+		if (!Predicted.Item || Predicted.Item->Definition != Definition || Predicted.ArrivedQuantity >= Predicted.Item->Quantity)
+		{
+			++i;
+			continue;
+		}
+
+		const int32 Taken = FMath::Min(Quantity, Predicted.Item->Quantity - Predicted.ArrivedQuantity);
+		Predicted.ArrivedQuantity += Taken;
+		Quantity -= Taken;
+
+		//the stand-in goes in the same update the real item arrives in, so the UI never sees a gap
+		if (Predicted.bConfirmed && Predicted.ArrivedQuantity >= Predicted.Item->Quantity)
+		{
+			RemovePredictedItemAt(i);
+			continue;
+		}
+
+		++i;
+	}
+}
+
+void UInventoryComponent::DropExpiredPredictions()
+{
+	const float Now = GetWorld()->GetTimeSeconds();
+	const int32 NumBefore = PredictedItems.Num();
+
+	for (int32 i = PredictedItems.Num() - 1; i >= 0; --i)
+	{
+		if (PredictedItems[i].bConfirmed && PredictedItems[i].DropDeadline <= Now)
+		{
+			RemovePredictedItemAt(i);
+		}
+	}
+
+	//from the timer nothing else is about to broadcast for us
+	if (PredictedItems.Num() != NumBefore && !bReplicatedUpdatePending)
+	{
+		BroadcastInventoryUpdated();
+	}
+
+	ScheduleNextPredictionDeadline();
+}
+
+void UInventoryComponent::ScheduleNextPredictionDeadline()
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	float NextDeadline = MAX_flt;
+
+	for (const FPredictedInventoryItem& Predicted : PredictedItems)
+	{
+		if (Predicted.bConfirmed)
+		{
+			NextDeadline = FMath::Min(NextDeadline, Predicted.DropDeadline);
+		}
+	}
+
+	if (NextDeadline == MAX_flt)
+	{
+		World->GetTimerManager().ClearTimer(TimerHandle_DropExpiredPredictions);
+		return;
+	}
+
+	//each confirmation keeps its own deadline, a later one never pushes an earlier one back
+	const float Delay = FMath::Max(NextDeadline - World->GetTimeSeconds(), KINDA_SMALL_NUMBER);
+	World->GetTimerManager().SetTimer(TimerHandle_DropExpiredPredictions, this, &UInventoryComponent::DropExpiredPredictions, Delay, false);
+}
+
+void UInventoryComponent::RemovePredictedItemAt(int32 Index)
+{
+	const FPredictedInventoryItem& Predicted = PredictedItems[Index];
+
+	if (Predicted.Item)
+	{
+		ApplyAggregateDelta(Predicted.Item->Definition, -Predicted.Item->Quantity);
+	}
+
+	PredictedItems.RemoveAt(Index); //keep the order the UI shows them in
+}
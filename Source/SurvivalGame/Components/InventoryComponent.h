@@ -4,25 +4,358 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Engine/NetSerialization.h"
 #include "InventoryComponent.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnInventoryUpdated);
+DECLARE_MULTICAST_DELEGATE(FOnInventoryUpdatedNative);
+
+//One stack in the inventory's replicated item list
+USTRUCT()
+struct FInventoryEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	FInventoryEntry()
+	{
+		Item = nullptr;
+		Quantity = 0;
+		AccountedDefinition = nullptr;
+		AccountedQuantity = 0;
+	}
+
+	//the item itself, replicated as a subobject of the inventory's owner
+	UPROPERTY()
+	class UItem* Item;
+
+	//copy of Item->Quantity. Quantity changes go out as a change to this entry, the item's own properties aren't compared again
+	UPROPERTY()
+	int32 Quantity;
+
+	//what this entry currently contributes to the inventory's cached weight/counts, not replicated
+	//lets every machine apply just the difference when the entry changes instead of recounting the inventory
+	const class UItemDefinition* AccountedDefinition;
+	int32 AccountedQuantity;
+
+	//client side callbacks, only called for entries that actually changed
+	void PreReplicatedRemove(const struct FInventoryList& InArraySerializer);
+	void PostReplicatedAdd(const struct FInventoryList& InArraySerializer);
+	void PostReplicatedChange(const struct FInventoryList& InArraySerializer);
+};
+
+//Fast array of every stack in an inventory, only added/removed/changed entries are sent
+USTRUCT()
+struct FInventoryList : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FInventoryEntry> Entries;
+
+	//inventory this list belongs to, so entry callbacks can reach it
+	UPROPERTY(NotReplicated)
+	class UInventoryComponent* OwnerComponent;
+
+	//skips connections that don't own an inventory that only replicates to its owner
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FInventoryList> : public TStructOpsTypeTraitsBase2<FInventoryList>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+//An amount of one item type, not tied to any particular stack
+USTRUCT(BlueprintType)
+struct FInventoryItemStack
+{
+	GENERATED_BODY()
+
+	FInventoryItemStack()
+	{
+		Definition = nullptr;
+		Quantity = 0;
+	}
+
+	FInventoryItemStack(class UItemDefinition* InDefinition, int32 InQuantity)
+	{
+		Definition = InDefinition;
+		Quantity = InQuantity;
+	}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory")
+	class UItemDefinition* Definition;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory")
+	int32 Quantity;
+
+	//Definition goes over the network as its item registry id
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FInventoryItemStack> : public TStructOpsTypeTraitsBase2<FInventoryItemStack>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+//A batch of adds and removes that is applied to an inventory all at once, or not at all
+//Removes are taken from existing stacks, adds top up partial stacks before opening new ones
+USTRUCT(BlueprintType)
+struct FInventoryTransaction
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory")
+	TArray<FInventoryItemStack> ItemsToAdd;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory")
+	TArray<FInventoryItemStack> ItemsToRemove;
+};
+
+//What a transaction would do to an inventory, worked out up front so a failed transaction never touches anything
+struct FInventoryTransactionPlan
+{
+	//existing items whose quantity changes, 0 means the stack goes away
+	TMap<class UItem*, int32> NewQuantities;
+
+	//stacks that have to be created
+	TArray<FInventoryItemStack> NewStacks;
+
+	int32 StackDelta = 0;
+	double WeightDelta = 0.0;
+};
+
+//[client] A stack the local player expects the server to give them, shown until the server answers
+USTRUCT()
+struct FPredictedInventoryItem
+{
+	GENERATED_BODY()
+
+	FPredictedInventoryItem()
+	{
+		PredictionKey = 0;
+		Item = nullptr;
+		bConfirmed = false;
+		ArrivedQuantity = 0;
+		DropDeadline = 0.f;
+	}
+
+	UPROPERTY()
+	int32 PredictionKey;
+
+	//local only, never replicated
+	UPROPERTY()
+	class UItem* Item;
+
+	//server accepted, waiting for the real item to replicate in before this one goes
+	UPROPERTY()
+	bool bConfirmed;
+
+	//how much of Item's definition has replicated in since we predicted it, it goes once this covers Item->Quantity
+	UPROPERTY()
+	int32 ArrivedQuantity;
+
+	//world time a confirmed prediction goes even if nothing matching arrived, in case it merged into something we can't tell apart
+	UPROPERTY()
+	float DropDeadline;
+};
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class SURVIVALGAME_API UInventoryComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
+	friend struct FInventoryEntry; //replication callbacks broadcast our delegates
+	friend struct FSurvivalPerfTestAccess; //automation perf tests serialize the replicated list directly
+
 public:	
 	// Sets default values for this component's properties
 	UInventoryComponent();
 
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+	virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+
+	//[server] Creates a new item of this type in the inventory as one stack
+	//Returns null if there's no room or Quantity is more than one stack holds, ApplyTransaction adds any amount
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Inventory")
+	class UItem* AddItemFromDefinition(class UItemDefinition* Definition, const int32 Quantity = 1);
+
+	//[server] Moves an existing item into this inventory, taking it out of any inventory it was in
+	//Returns the item now in the inventory, null if there was no room. An item that has already replicated as part of another actor
+	//can't change actors, it is replaced by a copy
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Inventory")
+	class UItem* AddItem(class UItem* Item);
+
+	//[server]
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Inventory")
+	bool RemoveItem(class UItem* Item);
+
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	TArray<class UItem*> GetItems() const;
+
+	//[local] Call when the inventory UI opens. Streams in the thumbnail and tooltip of everything held,
+	//OnInventoryUpdated fires once they are all in so the UI can show them. Does nothing if they are already loaded
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void LoadThumbnails();
+
+	//First stack of this item type, null if we don't have any
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	class UItem* FindItemByDefinition(const class UItemDefinition* Definition) const;
+
+	//Called by items after they change a replicated value, only that item's entry goes out in the next update
+	void MarkItemDirty(class UItem* Item);
+
+	//[client] An item's definition replicated after its entry did, it counts towards the aggregates from now
+	void OnItemDefinitionReplicated(class UItem* Item);
+
+	//AGGREGATES - kept up to date incrementally, all constant time so they are fine to poll every frame
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	FORCEINLINE float GetCurrentWeight() const { return (float)CurrentWeight; }
+
+	//Total quantity of this item type across every stack
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	int32 GetItemCount(const class UItemDefinition* Definition) const;
+
+	//Number of free stack slots, MAX_int32 if Capacity is unlimited
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	int32 GetRemainingCapacity() const;
+
+	//Weight that can still be added, MAX_FLT if WeightCapacity is unlimited
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	float GetRemainingWeightCapacity() const;
+
+	//Max number of stacks this inventory can hold, 0 = unlimited
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Inventory", meta = (ClampMin = 0))
+	int32 Capacity;
+
+	//Max total weight this inventory can hold, 0 = unlimited
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Inventory", meta = (ClampMin = 0.0))
+	float WeightCapacity;
+
+	//Only the owning player is sent the contents (a player's own inventory). Off for containers and bodies anyone can loot
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Inventory")
+	bool bReplicateToOwnerOnly;
+
+	//Whether this connection may be sent the contents
+	bool ShouldReplicateTo(const class UNetConnection* Connection) const;
+
+	//BULK OPERATIONS - one transaction, one OnInventoryUpdated and one replication update no matter how many stacks move
+	//Nothing is changed if any part fails (missing items, no free slots, too heavy)
+
+	//[server]
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Inventory")
+	bool ApplyTransaction(const FInventoryTransaction& Transaction);
+
+	//[server] Moves the given amounts from this inventory into Target, merging into Target's partial stacks
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Inventory")
+	bool TransferItems(UInventoryComponent* Target, const TArray<FInventoryItemStack>& Stacks);
+
+	//[server] Moves everything into Target (looting a crate or a body)
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Inventory")
+	bool TransferAllItems(UInventoryComponent* Target);
+
+	//PREDICTION - clients show what an instant interaction will give them straight away, see ASurvivalCharacter::BeginInteract
+
+	//[client] Shows a stack until the prediction is confirmed or rejected. Counts towards GetItems and the aggregates like a real one
+	void AddPredictedItem(int32 PredictionKey, class UItemDefinition* Definition, int32 Quantity);
+
+	//[client] Server agreed, the predicted stack goes once the real item has replicated in
+	void ConfirmPrediction(int32 PredictionKey);
+
+	//[client] Server refused, the predicted stack goes now
+	void RejectPrediction(int32 PredictionKey);
+
+	//Anything in the inventory was added, removed or changed, on server and clients
+	//Fired once per transaction on the server and at most once per frame on clients
+	UPROPERTY(BlueprintAssignable, Category = "Inventory")
+	FOnInventoryUpdated OnInventoryUpdated;
+
+	//same event for C++ listeners, fired first and without going through reflection
+	FOnInventoryUpdatedNative OnInventoryUpdatedNative;
+
 protected:
-	// Called when the game starts
-	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	UPROPERTY(Replicated)
+	FInventoryList Items;
+
+	//bumped whenever any item changes, lets ReplicateSubobjects skip looking at the items at all when nothing happened
+	int32 ReplicatedItemsKey;
+
+	FInventoryEntry* FindEntry(const class UItem* Item);
+
+	//Works out the result of a transaction without changing anything, false if it can't be applied
+	bool PlanTransaction(const FInventoryTransaction& Transaction, FInventoryTransactionPlan& OutPlan) const;
+	void CommitTransactionPlan(const FInventoryTransactionPlan& Plan);
+
+	//Whether the inventory stays within Capacity and WeightCapacity after gaining StackDelta stacks and WeightDelta weight
+	//single adds and transactions use the same test, so a transaction that was planned can always be committed
+	bool CanFit(int32 StackDelta, double WeightDelta) const;
+
+	//[server] Adds without checking the limits, callers have already done that
+	class UItem* AddNewStack(class UItemDefinition* Definition, int32 Quantity);
+	class UItem* AddItemUnchecked(class UItem* Item);
+
+	//While > 0 per-item events are held back and one OnInventoryUpdated goes out when the batch ends
+	int32 BatchDepth;
+	bool bBatchModified;
+
+	void BeginBatch();
+	void EndBatch();
+
+	//Broadcasts OnInventoryUpdated now, or once at the end of the current batch
+	void NotifyInventoryUpdated();
+
+	//Fires both update delegates, the Blueprint one only if anything is bound to it
+	void BroadcastInventoryUpdated();
+
+	//Clients: coalesce every entry that changed in one net update into a single OnInventoryUpdated next tick
+	void NotifyReplicatedUpdate();
+	void BroadcastReplicatedUpdate();
+	bool bReplicatedUpdatePending;
+
+	UPROPERTY()
+	TArray<FPredictedInventoryItem> PredictedItems;
+
+	//Before UpdateAggregates: whatever a replicated entry gained over what it accounted for counts as arrived
+	void MatchArrivedEntry(const FInventoryEntry& Entry);
+
+	//A replicated entry gained this much of Definition, hand it to the predictions waiting on that definition, oldest first
+	//Confirmed predictions it covers go straight away, unconfirmed ones keep it until the server's answer arrives
+	void MatchArrivedQuantity(const class UItemDefinition* Definition, int32 Quantity);
+
+	//Removes confirmed predictions whose DropDeadline has passed and waits for the next one
+	void DropExpiredPredictions();
+	void ScheduleNextPredictionDeadline();
+	void RemovePredictedItemAt(int32 Index);
+
+	//How long a confirmed prediction waits for its real item before it goes anyway
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory", meta = (ClampMin = 0.1))
+	float ConfirmedPredictionTimeout;
+
+	//set for whichever prediction's deadline comes first
+	FTimerHandle TimerHandle_DropExpiredPredictions;
+
+	//Bring the aggregates in line with the entry's current item/quantity, applying only the difference
+	void UpdateAggregates(FInventoryEntry& Entry);
+
+	//Take the entry's contribution back out before it leaves the inventory
+	void RemoveFromAggregates(FInventoryEntry& Entry);
+
+	void ApplyAggregateDelta(const class UItemDefinition* Definition, int32 QuantityDelta);
+
+	//double so thousands of small adds/removes don't drift
+	double CurrentWeight;
 
+	//total quantity held of each item type, types we have none of are removed
+	TMap<const class UItemDefinition*, int32> ItemCounts;
 		
 };
@@ -0,0 +1,334 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LootManagerComponent.h"
+#include "Components/InteractionComponent.h"
+#include "Items/Item.h"
+#include "Items/ItemDefinition.h"
+#include "Subsystems/PickupPool.h"
+#include "World/Pickup.h"
+#include "World/LootCell.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dormant Loot"), STAT_DormantLoot, STATGROUP_SurvivalGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Promoted Loot"), STAT_PromotedLoot, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Loot Promotions"), STAT_LootPromotions, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Loot Demotions"), STAT_LootDemotions, STATGROUP_SurvivalGame);
+
+FDormantLootGrid::FDormantLootGrid(float InCellSize)
+{
+	CellSize = FMath::Max(InCellSize, 1.f);
+}
+
+FIntPoint FDormantLootGrid::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void FDormantLootGrid::Add(int32 LootId, const FVector& Location)
+{
+	Remove(LootId);
+
+	Locations.Add(LootId, Location);
+	Cells.FindOrAdd(GetCell(Location)).Add(LootId);
+}
+
+void FDormantLootGrid::Remove(int32 LootId)
+{
+	FVector Location;
+	if (!Locations.RemoveAndCopyValue(LootId, Location))
+	{
+		return;
+	}
+
+	const FIntPoint Cell = GetCell(Location);
+	if (TArray<int32>* CellLoot = Cells.Find(Cell))
+	{
+		CellLoot->RemoveSingleSwap(LootId);
+
+		if (CellLoot->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+void FDormantLootGrid::FindLootNear(const TArray<FVector>& ViewerLocations, float Distance, TArray<int32>& OutLootIds) const
+{
+	const float DistanceSq = FMath::Square(Distance);
+
+	for (const FVector& Viewer : ViewerLocations)
+	{
+		const FIntPoint MinCell = GetCell(Viewer - FVector(Distance));
+		const FIntPoint MaxCell = GetCell(Viewer + FVector(Distance));
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				const TArray<int32>* CellLoot = Cells.Find(FIntPoint(X, Y));
+				if (!CellLoot)
+				{
+					continue;
+				}
+
+				for (const int32 LootId : *CellLoot)
+				{
+					if (FVector::DistSquared(Locations.FindChecked(LootId), Viewer) <= DistanceSq)
+					{
+						OutLootIds.AddUnique(LootId); //two players stood by the same loot only promote it once
+					}
+				}
+			}
+		}
+	}
+}
+
+bool FDormantLootGrid::ShouldDemote(const FVector& Location, const TArray<FVector>& ViewerLocations, float Distance)
+{
+	const float DistanceSq = FMath::Square(Distance);
+
+	for (const FVector& Viewer : ViewerLocations)
+	{
+		if (FVector::DistSquared(Location, Viewer) <= DistanceSq)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+ULootManagerComponent::ULootManagerComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false; //updates run on a timer
+
+	NextLootId = 0;
+
+	UpdateInterval = 0.25f;
+	PromotionMargin = 100.f;
+	DemotionHysteresis = 1.25f;
+	GridCellSize = 1000.f;
+	LootCellSize = 5000.f; //50 meters
+}
+
+ULootManagerComponent* ULootManagerComponent::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	AGameStateBase* GameState = World ? World->GetGameState() : nullptr;
+
+	return GameState ? GameState->FindComponentByClass<ULootManagerComponent>() : nullptr;
+}
+
+void ULootManagerComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	LootGrid = FDormantLootGrid(GridCellSize);
+
+	if (GetOwner()->HasAuthority())
+	{
+		GetWorld()->GetTimerManager().SetTimer(TimerHandle_UpdateLoot, this, &ULootManagerComponent::UpdateLoot, UpdateInterval, true);
+	}
+}
+
+void ULootManagerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(TimerHandle_UpdateLoot);
+	}
+
+	SET_DWORD_STAT(STAT_DormantLoot, 0);
+	SET_DWORD_STAT(STAT_PromotedLoot, 0);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ULootManagerComponent::AddDormantLoot(UItemDefinition* Definition, int32 Quantity, const FTransform& Transform)
+{
+	if (!Definition || Quantity <= 0 || !GetOwner()->HasAuthority())
+	{
+		return;
+	}
+
+	ALootCell* Cell = FindOrCreateLootCell(Transform.GetLocation());
+	if (!Cell)
+	{
+		return;
+	}
+
+	//each dormant entry becomes one pickup, so more than a stack is split into several piled up on the same spot
+	const int32 MaxQuantity = FMath::Max(Definition->GetMaxQuantity(), 1);
+
+	for (int32 Remaining = Quantity; Remaining > 0; Remaining -= MaxQuantity)
+	{
+		FDormantLoot NewLoot;
+		NewLoot.LootId = NextLootId++;
+		NewLoot.Definition = Definition;
+		NewLoot.ReplicatedDefinition.Definition = Definition;
+		NewLoot.Quantity = FMath::Min(Remaining, MaxQuantity);
+		NewLoot.Location = Transform.GetLocation();
+		NewLoot.Rotation = Transform.Rotator();
+
+		Cell->AddLoot(NewLoot);
+		LootGrid.Add(NewLoot.LootId, NewLoot.Location);
+
+		INC_DWORD_STAT(STAT_DormantLoot);
+	}
+}
+
+float ULootManagerComponent::GetPromotionDistance() const
+{
+	const UPickupPool* Pool = UPickupPool::Get(this);
+	const APickup* PickupCDO = Pool ? Pool->GetPickupClass()->GetDefaultObject<APickup>() : GetDefault<APickup>();
+	const float InteractionDistance = PickupCDO && PickupCDO->InteractionComponent ? PickupCDO->InteractionComponent->InteractionDistance : 200.f;
+
+	return InteractionDistance + PromotionMargin;
+}
+
+FIntPoint ULootManagerComponent::GetLootCellCoords(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / LootCellSize), FMath::FloorToInt(Location.Y / LootCellSize));
+}
+
+ALootCell* ULootManagerComponent::FindLootCell(const FVector& Location) const
+{
+	const TWeakObjectPtr<ALootCell>* Cell = LootCells.Find(GetLootCellCoords(Location));
+	return Cell ? Cell->Get() : nullptr;
+}
+
+ALootCell* ULootManagerComponent::FindOrCreateLootCell(const FVector& Location)
+{
+	if (ALootCell* Cell = FindLootCell(Location))
+	{
+		return Cell;
+	}
+
+	//the cell sits in the middle of its square, that's what the replication graph measures its cull distance from
+	const FIntPoint Coords = GetLootCellCoords(Location);
+	const FVector CellLocation((Coords.X + 0.5f) * LootCellSize, (Coords.Y + 0.5f) * LootCellSize, Location.Z);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	ALootCell* Cell = GetWorld()->SpawnActor<ALootCell>(ALootCell::StaticClass(), CellLocation, FRotator::ZeroRotator, SpawnParams);
+	if (Cell)
+	{
+		LootCells.Add(Coords, Cell);
+	}
+
+	return Cell;
+}
+
+void ULootManagerComponent::GetViewerLocations(TArray<FVector>& OutLocations) const
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+		if (const APawn* Pawn = PC ? PC->GetPawn() : nullptr)
+		{
+			OutLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+}
+
+void ULootManagerComponent::UpdateLoot()
+{
+	if (!GetOwner()->HasAuthority())
+	{
+		return;
+	}
+
+	TArray<FVector> ViewerLocations;
+	GetViewerLocations(ViewerLocations);
+
+	const float PromotionDistance = GetPromotionDistance();
+
+	//demote first so loot someone just walked away from isn't promoted again straight after
+	for (int32 i = PromotedLoot.Num() - 1; i >= 0; --i)
+	{
+		const FPromotedLoot& Promoted = PromotedLoot[i];
+		APickup* Pickup = Promoted.Pickup.Get();
+
+		//taken (the pickup went back to the pool, maybe already reused for something else) or destroyed, not ours anymore
+		if (!Pickup || Pickup->IsPendingKill() || !Promoted.Item.IsValid() || Pickup->GetItem() != Promoted.Item.Get())
+		{
+			PromotedLoot.RemoveAtSwap(i);
+			continue;
+		}
+
+		if (FDormantLootGrid::ShouldDemote(Pickup->GetActorLocation(), ViewerLocations, PromotionDistance * DemotionHysteresis))
+		{
+			DemoteLoot(Promoted);
+			PromotedLoot.RemoveAtSwap(i);
+		}
+	}
+
+	TArray<int32> LootToPromote;
+	LootGrid.FindLootNear(ViewerLocations, PromotionDistance, LootToPromote);
+
+	for (const int32 LootId : LootToPromote)
+	{
+		PromoteLoot(LootId);
+	}
+
+	SET_DWORD_STAT(STAT_PromotedLoot, PromotedLoot.Num());
+}
+
+void ULootManagerComponent::PromoteLoot(int32 LootId)
+{
+	const FVector* Location = LootGrid.FindLocation(LootId);
+	ALootCell* Cell = Location ? FindLootCell(*Location) : nullptr;
+	const FDormantLoot* Loot = Cell ? Cell->FindLoot(LootId) : nullptr;
+	UPickupPool* Pool = UPickupPool::Get(this);
+
+	if (!Loot || !Pool)
+	{
+		return;
+	}
+
+	UItem* Item = Pool->AcquireItem(GetOwner(), Loot->Definition, Loot->Quantity);
+	APickup* Pickup = Pool->AcquirePickup(GetWorld(), Item, FTransform(Loot->Rotation, Loot->Location));
+
+	if (!Pickup) //couldn't get an actor, leave it dormant and try again next update
+	{
+		Pool->ReleaseItem(Item);
+		return;
+	}
+
+	FPromotedLoot& Promoted = PromotedLoot.AddDefaulted_GetRef();
+	Promoted.Pickup = Pickup;
+	Promoted.Item = Item;
+
+	FDormantLoot RemovedLoot;
+	Cell->RemoveLoot(LootId, RemovedLoot);
+	LootGrid.Remove(LootId);
+
+	SURVIVAL_INC_COUNTER(STAT_LootPromotions);
+	DEC_DWORD_STAT(STAT_DormantLoot);
+}
+
+void ULootManagerComponent::DemoteLoot(const FPromotedLoot& Promoted)
+{
+	APickup* Pickup = Promoted.Pickup.Get();
+	UItem* Item = Promoted.Item.Get();
+
+	AddDormantLoot(Item->Definition, Item->Quantity, Pickup->GetActorTransform());
+
+	if (UPickupPool* Pool = UPickupPool::Get(this))
+	{
+		Pool->ReleasePickup(Pickup);
+	}
+	else
+	{
+		Pickup->Destroy();
+	}
+
+	SURVIVAL_INC_COUNTER(STAT_LootDemotions);
+}
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "LootManagerComponent.generated.h"
+
+/**
+ * Spatial lookup of dormant loot by id, plain data so the promote/demote decisions can run (and be tested) without a world or renderer
+ */
+struct SURVIVALGAME_API FDormantLootGrid
+{
+	FDormantLootGrid(float InCellSize = 1000.f);
+
+	void Add(int32 LootId, const FVector& Location);
+	void Remove(int32 LootId);
+
+	FORCEINLINE int32 Num() const { return Locations.Num(); }
+
+	FORCEINLINE const FVector* FindLocation(int32 LootId) const { return Locations.Find(LootId); }
+
+	//Every loot within Distance of any of the viewers
+	void FindLootNear(const TArray<FVector>& ViewerLocations, float Distance, TArray<int32>& OutLootIds) const;
+
+	//true if a promoted pickup at Location has nobody left within Distance and can go back to being an instance
+	static bool ShouldDemote(const FVector& Location, const TArray<FVector>& ViewerLocations, float Distance);
+
+private:
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	float CellSize;
+
+	TMap<FIntPoint, TArray<int32>> Cells;
+	TMap<int32, FVector> Locations;
+};
+
+//A pickup that was promoted out of the dormant list, and the item it was given, so we can tell once a player has taken it
+struct FPromotedLoot
+{
+	TWeakObjectPtr<class APickup> Pickup;
+
+	TWeakObjectPtr<class UItem> Item;
+};
+
+/**
+ * Keeps idle world loot as instances of one hierarchical instanced mesh per pickup mesh instead of an actor each.
+ * The server promotes loot to a real APickup (from the pickup pool) when a player comes within interaction range
+ * and demotes it back to an instance once everyone has left, so only loot someone is standing next to costs an actor,
+ * tick registration, interaction component and draw call.
+ * The loot itself lives in ALootCell actors, one per LootCellSize square that has loot, which the replication graph
+ * only sends to players near them. This component is just the server's bookkeeping and doesn't replicate.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class SURVIVALGAME_API ULootManagerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:	
+
+	ULootManagerComponent();
+
+	//Helper function to grab the loot manager off the world's game state
+	static ULootManagerComponent* Get(const UObject* WorldContextObject);
+
+	//[server] Place loot in the world, it starts dormant and is promoted when a player comes close
+	//More than one stack's worth is placed as several full stacks at the same spot
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Loot")
+	void AddDormantLoot(class UItemDefinition* Definition, int32 Quantity, const FTransform& Transform);
+
+	//[server] Run one promote/demote pass now, normally done every UpdateInterval
+	void UpdateLoot();
+
+	FORCEINLINE int32 GetNumDormantLoot() const { return LootGrid.Num(); }
+	FORCEINLINE int32 GetNumPromotedLoot() const { return PromotedLoot.Num(); }
+	FORCEINLINE int32 GetNumLootCells() const { return LootCells.Num(); }
+
+	//How often the server looks for loot to promote/demote
+	UPROPERTY(EditDefaultsOnly, Category = "Loot", meta = (ClampMin = 0.05))
+	float UpdateInterval;
+
+	//Added on top of the pickup's InteractionDistance, so the actor exists before the interaction check wants it
+	UPROPERTY(EditDefaultsOnly, Category = "Loot", meta = (ClampMin = 0.0))
+	float PromotionMargin;
+
+	//Multiplier on the promotion distance before loot is demoted again, stops loot flickering at the edge
+	UPROPERTY(EditDefaultsOnly, Category = "Loot", meta = (ClampMin = 1.0))
+	float DemotionHysteresis;
+
+	//Cell size of the server's promotion lookup
+	UPROPERTY(EditDefaultsOnly, Category = "Loot", meta = (ClampMin = 100.0))
+	float GridCellSize;
+
+	//Size of the square each ALootCell covers. Smaller cells send less far away loot, bigger ones mean fewer actors
+	UPROPERTY(EditDefaultsOnly, Category = "Loot", meta = (ClampMin = 1000.0))
+	float LootCellSize;
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	//[server] what the grid is searched with
+	FDormantLootGrid LootGrid;
+
+	TArray<FPromotedLoot> PromotedLoot;
+
+	//[server] every cell that has been given loot, by LootCellSize square
+	TMap<FIntPoint, TWeakObjectPtr<class ALootCell>> LootCells;
+
+	int32 NextLootId;
+
+	FTimerHandle TimerHandle_UpdateLoot;
+
+	//From the pickup class the pool actually spawns, a blueprint pickup can have its own InteractionDistance
+	float GetPromotionDistance() const;
+
+	//Pawn locations of every player, what promotion is measured against
+	void GetViewerLocations(TArray<FVector>& OutLocations) const;
+
+	FIntPoint GetLootCellCoords(const FVector& Location) const;
+	class ALootCell* FindLootCell(const FVector& Location) const;
+	class ALootCell* FindOrCreateLootCell(const FVector& Location);
+
+	void PromoteLoot(int32 LootId);
+	void DemoteLoot(const FPromotedLoot& Promoted);
+};
@@ -2,20 +2,33 @@
 
 
 #include "FoodItem.h"
+#include "Items/FoodItemDefinition.h"
 
 #define LOCTEXT_NAMESPACE "FoodItem"
 
 UFoodItem::UFoodItem()
 {
-	HealAmount = 20.f;
-	UseActionText = LOCTEXT("ItemUseActionText", "Consume");
-
+#if WITH_EDITORONLY_DATA
+	HealAmount_DEPRECATED = 20.f;
+	UseActionText_DEPRECATED = LOCTEXT("ItemUseActionText", "Consume");
+#endif
 }
 
-void UFoodItem::Use(ASurvivalCharacter * Character)
+#if WITH_EDITOR
+TSubclassOf<UItemDefinition> UFoodItem::GetLegacyDefinitionClass() const
 {
-	//heal character here
+	return UFoodItemDefinition::StaticClass();
 }
 
+void UFoodItem::CopyLegacyData(UItemDefinition* NewDefinition) const
+{
+	Super::CopyLegacyData(NewDefinition);
+
+	if (UFoodItemDefinition* FoodDefinition = Cast<UFoodItemDefinition>(NewDefinition))
+	{
+		FoodDefinition->HealAmount = HealAmount_DEPRECATED;
+	}
+}
+#endif
 
-#undef LOCTEXT_NAMESPACE
\ No newline at end of file
+#undef LOCTEXT_NAMESPACE
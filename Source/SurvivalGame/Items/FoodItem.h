@@ -7,9 +7,10 @@
 #include "FoodItem.generated.h"
 
 /**
- * 
+ * LEGACY - food used to be an item subclass, it is a UFoodItemDefinition now.
+ * Kept so food Blueprints made before the split still load and can be migrated (UItem::MigrateToItemDefinition)
  */
-UCLASS()
+UCLASS(HideDropdown)
 class SURVIVALGAME_API UFoodItem : public UItem
 {
 	GENERATED_BODY()
@@ -18,10 +19,14 @@ public:
 
 	UFoodItem();
 
-	//amount that the food heals
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Healing")
-	float HealAmount;
-	
-	virtual void Use(class ASurvivalCharacter* Character) override;
+#if WITH_EDITOR
+	virtual TSubclassOf<class UItemDefinition> GetLegacyDefinitionClass() const override;
+	virtual void CopyLegacyData(class UItemDefinition* NewDefinition) const override;
+#endif
+
+#if WITH_EDITORONLY_DATA
+	UPROPERTY()
+	float HealAmount_DEPRECATED;
+#endif
 
 };
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FoodItemDefinition.h"
+
+#define LOCTEXT_NAMESPACE "FoodItem"
+
+UFoodItemDefinition::UFoodItemDefinition()
+{
+	HealAmount = 20.f;
+	UseActionText = LOCTEXT("ItemUseActionText", "Consume");
+
+}
+
+void UFoodItemDefinition::Use(UItem* Item, ASurvivalCharacter* Character) const
+{
+	//heal character here
+}
+
+
+#undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Items/ItemDefinition.h"
+#include "FoodItemDefinition.generated.h"
+
+/**
+ * 
+ */
+UCLASS()
+class SURVIVALGAME_API UFoodItemDefinition : public UItemDefinition
+{
+	GENERATED_BODY()
+
+public:
+
+	UFoodItemDefinition();
+
+	//amount that the food heals
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Healing")
+	float HealAmount;
+	
+	virtual void Use(class UItem* Item, class ASurvivalCharacter* Character) const override;
+
+};
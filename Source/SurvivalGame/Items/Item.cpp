@@ -2,7 +2,22 @@
 
 
 #include "Item.h"
+#include "Items/ItemDefinition.h"
+#include "Components/InventoryComponent.h"
 #include "Net/UnrealNetwork.h"
+#include "SurvivalGame.h"
+
+#if WITH_EDITOR
+#include "Engine/Blueprint.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/Texture2D.h"
+#include "AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "Widgets/ItemToolTip.h"
+#endif
+
+DECLARE_CYCLE_STAT(TEXT("Item Mark Dirty"), STAT_ItemMarkDirty, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Item Definition Replicated"), STAT_ItemDefinitionReplicated, STATGROUP_SurvivalGame);
 
 
 #define LOCTEXT_NAMESPACE "Item"
@@ -11,7 +26,9 @@ void UItem::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty> & OutLife
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(UItem, Quantity); //tells quantity value to be replicated, server is now managing this value
+	//Quantity goes through the inventory's fast array entry instead, so a stack change doesn't need a property compare here
+	//not initial only, pooled items change type when they are reused. RepKey keeps it from being compared the rest of the time
+	DOREPLIFETIME(UItem, ReplicatedDefinition);
 }
 
 bool UItem::IsSupportedForNetworking() const
@@ -30,39 +47,114 @@ void UItem::PostEditChangeProperty(FPropertyChangedEvent & PropertyChangedEvent)
 	if (ChangedPropertyName == GET_MEMBER_NAME_CHECKED(UItem, Quantity))
 	{
 		//quantity = clamp quantity between 1 and maxstacksize
-		Quantity = FMath::Clamp(Quantity, 1, bCanStack ? MaxStackSize : 1);
+		Quantity = FMath::Clamp(Quantity, 1, GetMaxQuantity());
 	}
 }
+
+void UItem::PostLoad()
+{
+	Super::PostLoad();
+
+	if (HasAnyFlags(RF_ClassDefaultObject) && !Definition && GetClass()->ClassGeneratedBy)
+	{
+		UE_LOG(LogSurvivalGame, Warning, TEXT("%s has no item definition, if it was made before UItemDefinition use Migrate To Item Definition in its class defaults"), *GetClass()->GetName());
+	}
+}
+
+TSubclassOf<UItemDefinition> UItem::GetLegacyDefinitionClass() const
+{
+	return UItemDefinition::StaticClass();
+}
+
+void UItem::CopyLegacyData(UItemDefinition* NewDefinition) const
+{
+	NewDefinition->PickupMesh = PickupMesh_DEPRECATED;
+	NewDefinition->Thumbnail = Thumbnail_DEPRECATED;
+	NewDefinition->ItemDisplayName = ItemDisplayName_DEPRECATED;
+	NewDefinition->ItemDescription = ItemDescription_DEPRECATED;
+	NewDefinition->UseActionText = UseActionText_DEPRECATED;
+	NewDefinition->Rarity = Rarity_DEPRECATED;
+	NewDefinition->Weight = Weight_DEPRECATED;
+	NewDefinition->bCanStack = bCanStack_DEPRECATED;
+	NewDefinition->MaxStackSize = MaxStackSize_DEPRECATED;
+	NewDefinition->ItemTooltip = ItemTooltip_DEPRECATED.Get();
+}
 #endif
 
+void UItem::MigrateToItemDefinition()
+{
+#if WITH_EDITOR
+	UBlueprint* Blueprint = Cast<UBlueprint>(GetClass()->ClassGeneratedBy);
+	if (!Blueprint || Definition)
+	{
+		return;
+	}
+
+	//DA_<Blueprint name> in the Blueprint's folder
+	const FString AssetName = TEXT("DA_") + Blueprint->GetName();
+	const FString PackageName = FPackageName::GetLongPackagePath(Blueprint->GetOutermost()->GetName()) / AssetName;
+
+	UPackage* Package = CreatePackage(nullptr, *PackageName);
+	UItemDefinition* NewDefinition = NewObject<UItemDefinition>(Package, GetLegacyDefinitionClass(), *AssetName, RF_Public | RF_Standalone | RF_Transactional);
+	CopyLegacyData(NewDefinition);
+
+	FAssetRegistryModule::AssetCreated(NewDefinition);
+	Package->MarkPackageDirty();
+
+	//on the class defaults, so every item of this class starts out with it
+	UItem* ClassDefaults = GetClass()->GetDefaultObject<UItem>();
+	ClassDefaults->Modify();
+	ClassDefaults->Definition = NewDefinition;
+	ClassDefaults->MarkPackageDirty();
+	Blueprint->MarkPackageDirty();
+
+	UE_LOG(LogSurvivalGame, Display, TEXT("Migrated %s to item definition %s, save both"), *Blueprint->GetName(), *PackageName);
+#endif
+}
+
 UItem::UItem()
 {
 	//Defaults
-	ItemDisplayName = LOCTEXT("ItemName", "Item");
-	UseActionText = LOCTEXT("ItemUseActionText", "Use");
-	Weight = 0.f;
-	bCanStack = true;
+	Definition = nullptr;
 	Quantity = 1;
-	MaxStackSize = 2;
+	OwningInventory = nullptr;
 	RepKey = 0;
+	bHasReplicated = false;
+
+#if WITH_EDITORONLY_DATA
+	//what the legacy properties defaulted to, Blueprints only saved the values they changed
+	PickupMesh_DEPRECATED = nullptr;
+	Thumbnail_DEPRECATED = nullptr;
+	ItemDisplayName_DEPRECATED = LOCTEXT("ItemName", "Item");
+	UseActionText_DEPRECATED = LOCTEXT("ItemUseActionText", "Use");
+	Rarity_DEPRECATED = EItemRarity::IR_Common;
+	Weight_DEPRECATED = 0.f;
+	bCanStack_DEPRECATED = true;
+	MaxStackSize_DEPRECATED = 2;
+#endif
 
 }
 
-void UItem::OnRep_Quantity()
-{
-	OnItemModified.Broadcast();
-}
-
 void UItem::SetQuantity(const int32 NewQuantity)
 {
 	if (NewQuantity != Quantity)
 	{
 		//quantity = clamp new quantity between 0 and maxstacksize
-		Quantity = FMath::Clamp(NewQuantity, 0, bCanStack ? MaxStackSize : 1);
+		Quantity = FMath::Clamp(NewQuantity, 0, GetMaxQuantity());
 		MarkDirtyForReplication();
 	}
 }
 
+float UItem::GetStackWeight() const
+{
+	return Definition ? Quantity * Definition->Weight : 0.f;
+}
+
+int32 UItem::GetMaxQuantity() const
+{
+	return Definition ? Definition->GetMaxQuantity() : 1;
+}
+
 bool UItem::ShouldShowInInventory() const
 {
 	return true;
@@ -70,15 +162,59 @@ bool UItem::ShouldShowInInventory() const
 
 void UItem::Use(ASurvivalCharacter * Character)
 {
+	if (Definition)
+	{
+		Definition->Use(this, Character);
+	}
+}
+
+void UItem::AddedToInventory(UInventoryComponent * Inventory)
+{
+}
+
+void UItem::ResetItem()
+{
+	Definition = nullptr;
+	Quantity = 1;
+	OwningInventory = nullptr;
+	OnItemModified.Clear();
+	OnItemModifiedNative.Clear();
+	MarkDirtyForReplication();
 }
 
-void UItem::AddedToInventory(UInventory * Inventory)
+void UItem::BroadcastItemModified()
 {
+	OnItemModifiedNative.Broadcast();
+
+	if (OnItemModified.IsBound())
+	{
+		OnItemModified.Broadcast();
+	}
+}
+
+void UItem::OnRep_ReplicatedDefinition()
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_ItemDefinitionReplicated);
+
+	Definition = ReplicatedDefinition.Definition;
+
+	if (OwningInventory) //the entry may have arrived before we knew what we were
+	{
+		OwningInventory->OnItemDefinitionReplicated(this);
+	}
 }
 
 void UItem::MarkDirtyForReplication()
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_ItemMarkDirty);
 
+	++RepKey; //our own properties get compared again on the next net update
+	ReplicatedDefinition.Definition = Definition;
+
+	if (OwningInventory) //refresh our entry so only it goes out in the inventory's next delta
+	{
+		OwningInventory->MarkItemDirty(this);
+	}
 }
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
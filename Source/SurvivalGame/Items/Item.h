@@ -4,25 +4,20 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Subsystems/ItemRegistry.h"
+#include "Items/ItemDefinition.h"
 #include "Item.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnItemModified);
-
-UENUM(BlueprintType)
-enum class EItemRarity : uint8
-{
-	IR_Common UMETA(DisplayName = "Common"),
-	IR_Uncommon UMETA(DisplayName = "Uncommon"),
-	IR_Rare UMETA(DisplayName = "Rare"),
-	IR_VeryRare UMETA(DisplayName = "Very Rare"),
-	IR_Legendary UMETA(DisplayName = "Legendary")
-
-};
+DECLARE_MULTICAST_DELEGATE(FOnItemModifiedNative);
 
 //ITEMS ONLY EXIST WITHIN AN INVENTORY
 
 /**
- * 
+ * One stack of an item: which definition it is, how many there are and which inventory holds it.
+ * Static data (mesh, name, weight...) lives on the shared UItemDefinition.
+ * Every stack is still its own UObject since it replicates as a subobject and is used from Blueprint,
+ * so the split cuts what each stack holds and references, not the number of objects.
  */
 UCLASS(Blueprintable, EditInlineNew, DefaultToInstanced)
 class SURVIVALGAME_API UItem : public UObject
@@ -35,86 +30,122 @@ protected:
 
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PostLoad() override;
+
+	//Definition class the legacy data of this item class is migrated to, and copying it across
+	virtual TSubclassOf<class UItemDefinition> GetLegacyDefinitionClass() const;
+	virtual void CopyLegacyData(class UItemDefinition* NewDefinition) const;
 #endif
 
-public:
+#if WITH_EDITORONLY_DATA
+	//LEGACY - static data item Blueprints saved before it moved to UItemDefinition, loaded through the property redirects
+	//in SurvivalGame.cpp. Only read by MigrateToItemDefinition, never saved again
+	UPROPERTY()
+	class UStaticMesh* PickupMesh_DEPRECATED;
 
-	UItem();
+	UPROPERTY()
+	class UTexture2D* Thumbnail_DEPRECATED;
 
-	//The mesh to display for the item's pickup
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	class UStaticMesh* PickupMesh;
+	UPROPERTY()
+	FText ItemDisplayName_DEPRECATED;
 
-	//thumbnail displayed in the inventory
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
-	class UTexture2D* Thumbnail;
+	UPROPERTY()
+	FText ItemDescription_DEPRECATED;
 
-	//name of item in inventory
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	FText ItemDisplayName;
+	UPROPERTY()
+	FText UseActionText_DEPRECATED;
 
-	//optional description of the item in the inventory
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (MultiLine = true))
-	FText ItemDescription;
+	UPROPERTY()
+	EItemRarity Rarity_DEPRECATED;
 
-	//action text for item, (ie Eat, Use, Equip, etc...)
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	FText UseActionText;
+	UPROPERTY()
+	float Weight_DEPRECATED;
 
-	//Rarity of the item using rarity enum
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	EItemRarity Rarity;
+	UPROPERTY()
+	bool bCanStack_DEPRECATED;
 
-	//Weight of the item
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (clampMin = 0.0))
-	float Weight;
+	UPROPERTY()
+	int32 MaxStackSize_DEPRECATED;
 
-	//Whether or not this item can stack in the inventory
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	bool bCanStack;
+	UPROPERTY()
+	TSubclassOf<class UItemToolTip> ItemTooltip_DEPRECATED;
+#endif
+
+public:
 
-	//maximum number of items that can be stacked
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (clampMin = 2, EditCondition = bCanStack))
-	int32 MaxStackSize;
+	UItem();
 
-	//tooltip in the inventory for this item
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	TSubclassOf<class UItemTooltip> ItemTooltip;
+	//Shared, read only data and behaviour for this type of item. Everything below is per-item
+	//reaches clients through ReplicatedDefinition, as a registry id rather than an object reference
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item")
+	class UItemDefinition* Definition;
 
 	//amount of items currently held
-	UPROPERTY(ReplicatedUsing = OnRep_Quantity, EditAnywhere, Category = "Item", meta = (UIMin = 1, EditCondition = bCanStack))
-	int32 Quantity; //replicated variable, managed by the server, client calls this function when server issues an update to the quantity value
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item", meta = (UIMin = 1))
+	int32 Quantity; //managed by the server, reaches clients through the owning inventory's entry for this item
 
 	//ref to inventory that contains this item
 	UPROPERTY()
 	class UInventoryComponent* OwningInventory;
 
 
-	UPROPERTY() //how server knows it needs to update client
+	UPROPERTY() //how server knows it needs to update client, the inventory skips comparing our properties until this changes
 	int32 RepKey;
 
+	//copy of Definition for replication, refreshed by MarkDirtyForReplication
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedDefinition)
+	FReplicatedItemDefinition ReplicatedDefinition;
+
+	UFUNCTION()
+	void OnRep_ReplicatedDefinition();
+
+	//fired on server and clients whenever the quantity changes
 	UPROPERTY(BlueprintAssignable)
 	FOnItemModified OnItemModified;
 
-	UFUNCTION()
-	void OnRep_Quantity();
+	//same event for C++ listeners, skips the reflected call
+	FOnItemModifiedNative OnItemModifiedNative;
+
+	//Fires both, the Blueprint delegate only if anything is bound to it
+	void BroadcastItemModified();
 
 	UFUNCTION(BlueprintCallable, Category = "item")
 	void SetQuantity(const int32 NewQuantity);
 
 	UFUNCTION(BlueprintCallable, Category = "item")
-		FORCEINLINE float GetStackWeight() const { return Quantity * Weight; };
+	float GetStackWeight() const;
+
+	//largest quantity this item can hold, 1 if the definition doesn't stack
+	UFUNCTION(BlueprintPure, Category = "Item")
+	int32 GetMaxQuantity() const;
 
 	//equiped items shouldn't appear in inventory
 	UFUNCTION(BlueprintPure, Category = "Item")
 	virtual bool ShouldShowInInventory() const;
 
-	//by marking virtual can be overriden so that Use does something diff on call
-	virtual void Use(class ASurvivalCharacter* Character);
-	virtual void AddedToInventory(class UInventory* Inventory);
+	//[editor] Creates a UItemDefinition asset next to this item Blueprint from its legacy data and points Definition at it
+	//Use on Blueprints made before the split, then save both
+	UFUNCTION(CallInEditor, Category = "Item")
+	void MigrateToItemDefinition();
+
+	//Forwards to the definition, item types customise Use by subclassing UItemDefinition
+	void Use(class ASurvivalCharacter* Character);
+	virtual void AddedToInventory(class UInventoryComponent* Inventory);
+
+	//Back to a blank item before it goes into the pool, nothing from its last stack may leak into the next one
+	void ResetItem();
 
 
 	//mark object as needing replication. Must call internally after modifying any replicated properties
 	void MarkDirtyForReplication();
 
+	//[server] Once sent to any connection clients know the item by a NetGUID tied to its outer actor,
+	//so it must never be renamed into another actor or recycled through the pickup pool
+	FORCEINLINE void MarkReplicated() { bHasReplicated = true; }
+	FORCEINLINE bool HasReplicated() const { return bHasReplicated; }
+
+protected:
+
+	bool bHasReplicated;
+
 };
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemDefinition.h"
+#include "Engine/Texture2D.h"
+#include "Widgets/ItemToolTip.h"
+#include "Subsystems/ItemRegistry.h"
+
+#define LOCTEXT_NAMESPACE "Item"
+
+UItemDefinition::UItemDefinition()
+{
+	//Defaults
+	ItemDisplayName = LOCTEXT("ItemName", "Item");
+	UseActionText = LOCTEXT("ItemUseActionText", "Use");
+	Rarity = EItemRarity::IR_Common;
+	Weight = 0.f;
+	PickupRadius = 30.f;
+	bCanStack = true;
+	MaxStackSize = 2;
+	ItemId = 0;
+}
+
+FPrimaryAssetId UItemDefinition::GetPrimaryAssetId() const
+{
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		return Super::GetPrimaryAssetId();
+	}
+
+	return FPrimaryAssetId(UItemRegistry::ItemAssetType, GetFName());
+}
+
+UTexture2D* UItemDefinition::GetLoadedThumbnail() const
+{
+	return Thumbnail.Get();
+}
+
+TSubclassOf<UItemToolTip> UItemDefinition::GetLoadedTooltipClass() const
+{
+	return ItemTooltip.Get();
+}
+
+void UItemDefinition::Use(UItem* Item, ASurvivalCharacter* Character) const
+{
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ItemDefinition.generated.h"
+
+UENUM(BlueprintType)
+enum class EItemRarity : uint8
+{
+	IR_Common UMETA(DisplayName = "Common"),
+	IR_Uncommon UMETA(DisplayName = "Uncommon"),
+	IR_Rare UMETA(DisplayName = "Rare"),
+	IR_VeryRare UMETA(DisplayName = "Very Rare"),
+	IR_Legendary UMETA(DisplayName = "Legendary")
+
+};
+
+//ONE DEFINITION PER TYPE OF ITEM, SHARED BY EVERY UItem OF THAT TYPE
+
+/**
+ * Everything about an item that is the same for every copy of it (mesh, name, weight, stacking rules...)
+ * and the behaviour of using it. Item instances only point at one of these, so a player holding 40 stacks
+ * doesn't carry 40 copies of the same text, textures and settings.
+ */
+UCLASS(Blueprintable, BlueprintType)
+class SURVIVALGAME_API UItemDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UItemDefinition();
+
+	//Every definition subclass (food, weapons...) registers as the same primary asset type so the item registry finds them together
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	//Network/save id of this item type, see UItemRegistry. 0 lets the registry pick one, which can change as items are added,
+	//so give an item a fixed id once save data may refer to it
+	UPROPERTY(EditDefaultsOnly, AssetRegistrySearchable, Category = "Item", meta = (ClampMin = 0, ClampMax = 65535))
+	int32 ItemId;
+
+	//COSMETICS - soft references, streamed in through UAssetStreamingManager when something is about to show them
+	//so referencing a definition (inventories, loot tables) doesn't pull its mesh and textures into memory
+	//also tagged with asset bundles, servers load definitions without any
+
+	//The mesh to display for the item's pickup
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (AssetBundles = "World"))
+	TSoftObjectPtr<class UStaticMesh> PickupMesh;
+
+	//Roughly how big PickupMesh is, players can focus the pickup from this far off its center
+	//not measured from the mesh since servers never load it and have to check focus the same way clients do
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (ClampMin = 0.0))
+	float PickupRadius;
+
+	//thumbnail displayed in the inventory, loaded when the inventory UI opens (UInventoryComponent::LoadThumbnails)
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (AssetBundles = "UI"))
+	TSoftObjectPtr<class UTexture2D> Thumbnail;
+
+	//name of item in inventory
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	FText ItemDisplayName;
+
+	//optional description of the item in the inventory
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (MultiLine = true))
+	FText ItemDescription;
+
+	//action text for item, (ie Eat, Use, Equip, etc...)
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	FText UseActionText;
+
+	//Rarity of the item using rarity enum
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	EItemRarity Rarity;
+
+	//Weight of a single item
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (clampMin = 0.0))
+	float Weight;
+
+	//Whether or not this item can stack in the inventory
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	bool bCanStack;
+
+	//maximum number of items that can be stacked
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (clampMin = 2, EditCondition = bCanStack))
+	int32 MaxStackSize;
+
+	//tooltip in the inventory for this item, loaded along with the thumbnail
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (AssetBundles = "UI"))
+	TSoftClassPtr<class UItemToolTip> ItemTooltip;
+
+	//The thumbnail if it has been loaded, null otherwise
+	UFUNCTION(BlueprintPure, Category = "Item")
+	class UTexture2D* GetLoadedThumbnail() const;
+
+	//The tooltip class if it has been loaded, null otherwise
+	UFUNCTION(BlueprintPure, Category = "Item")
+	TSubclassOf<class UItemToolTip> GetLoadedTooltipClass() const;
+
+	//largest quantity a single item of this type can hold
+	FORCEINLINE int32 GetMaxQuantity() const { return bCanStack ? MaxStackSize : 1; }
+
+	//What happens when a player uses an item of this type, override in subclasses (food heals etc)
+	//const because definitions are shared, anything that changes belongs on the item or the character
+	virtual void Use(class UItem* Item, class ASurvivalCharacter* Character) const;
+
+};
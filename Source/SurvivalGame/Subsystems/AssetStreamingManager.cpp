@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AssetStreamingManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Asset Stream Requests"), STAT_AssetStreamRequests, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Asset Stream Cache Hits"), STAT_AssetStreamCacheHits, STATGROUP_SurvivalGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cached Streamed Assets"), STAT_CachedStreamedAssets, STATGROUP_SurvivalGame);
+
+UAssetStreamingManager::UAssetStreamingManager()
+{
+	MaxCachedAssets = 64;
+}
+
+UAssetStreamingManager* UAssetStreamingManager::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		return UGameInstance::GetSubsystem<UAssetStreamingManager>(World->GetGameInstance());
+	}
+
+	return nullptr;
+}
+
+void UAssetStreamingManager::Deinitialize()
+{
+	for (auto& Cached : CachedAssets)
+	{
+		for (const TSharedPtr<FStreamableHandle>& Handle : Cached.Value.Handles)
+		{
+			if (Handle->IsLoadingInProgress())
+			{
+				Handle->CancelHandle(); //nothing is left to hear about it
+			}
+			else
+			{
+				Handle->ReleaseHandle();
+			}
+		}
+	}
+
+	DEC_DWORD_STAT_BY(STAT_CachedStreamedAssets, CachedAssets.Num());
+	CachedAssets.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UAssetStreamingManager::ShouldStreamCosmetics() const
+{
+	if (UE_SERVER || IsRunningDedicatedServer())
+	{
+		return false;
+	}
+
+	const UWorld* World = GetGameInstance() ? GetGameInstance()->GetWorld() : nullptr;
+	return !World || World->GetNetMode() != NM_DedicatedServer; //PIE dedicated servers share the process with clients
+}
+
+TAsyncLoadPriority UAssetStreamingManager::GetLoadPriority(EAssetStreamingPriority Priority)
+{
+	switch (Priority)
+	{
+	case EAssetStreamingPriority::High:
+		return FStreamableManager::AsyncLoadHighPriority;
+	case EAssetStreamingPriority::Normal:
+		return FStreamableManager::AsyncLoadHighPriority / 2;
+	default:
+		return FStreamableManager::DefaultAsyncLoadPriority;
+	}
+}
+
+bool UAssetStreamingManager::RequestAsset(const FSoftObjectPath& Path, EAssetStreamingPriority Priority, FSimpleDelegate OnLoaded)
+{
+	if (Path.IsNull() || !ShouldStreamCosmetics())
+	{
+		return false;
+	}
+
+	SURVIVAL_INC_COUNTER(STAT_AssetStreamRequests);
+
+	FStreamedAsset* Cached = CachedAssets.Find(Path);
+	if (!Cached)
+	{
+		Cached = &CachedAssets.Add(Path);
+		INC_DWORD_STAT(STAT_CachedStreamedAssets);
+	}
+
+	Cached->LastUsedTime = FPlatformTime::Seconds();
+
+	//already in memory, just make sure the cache holds on to it
+	if (Path.ResolveObject())
+	{
+		SURVIVAL_INC_COUNTER(STAT_AssetStreamCacheHits);
+
+		if (Cached->Handles.Num() == 0)
+		{
+			Cached->Handles.Add(StreamableManager.RequestAsyncLoad(Path, FStreamableDelegate(), GetLoadPriority(Priority)));
+		}
+
+		OnLoaded.ExecuteIfBound();
+		TrimCache();
+		return true;
+	}
+
+	//a new request for an asset that is already loading only merges into the existing load
+	//if it is wanted sooner than before the async loader bumps the package up its queue
+	Cached->Priority = FMath::Max(Cached->Priority, Priority);
+
+	TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(Path,
+		FStreamableDelegate::CreateUObject(this, &UAssetStreamingManager::OnAssetLoaded, Path, OnLoaded), GetLoadPriority(Cached->Priority));
+
+	//found again, the map may have grown if the delegate already ran
+	FStreamedAsset* Loading = CachedAssets.Find(Path);
+	if (Handle.IsValid() && Loading)
+	{
+		Loading->Handles.Add(Handle);
+	}
+
+	return true;
+}
+
+bool UAssetStreamingManager::RequestAssets(const TArray<FSoftObjectPath>& Paths, EAssetStreamingPriority Priority, FSimpleDelegate OnLoaded)
+{
+	//count every path first, assets that are already loaded call back before the loop finishes
+	TSharedRef<int32> Remaining = MakeShared<int32>(Paths.Num() + 1);
+
+	FSimpleDelegate OnEachLoaded = FSimpleDelegate::CreateLambda([Remaining, OnLoaded]()
+	{
+		if (--(*Remaining) == 0)
+		{
+			OnLoaded.ExecuteIfBound();
+		}
+	});
+
+	bool bAnyRequested = false;
+
+	for (const FSoftObjectPath& Path : Paths)
+	{
+		if (RequestAsset(Path, Priority, OnEachLoaded))
+		{
+			bAnyRequested = true;
+		}
+		else
+		{
+			--(*Remaining);
+		}
+	}
+
+	if (!bAnyRequested)
+	{
+		return false;
+	}
+
+	OnEachLoaded.Execute(); //the extra count from above
+	return true;
+}
+
+void UAssetStreamingManager::OnAssetLoaded(FSoftObjectPath Path, FSimpleDelegate OnLoaded)
+{
+	if (FStreamedAsset* Cached = CachedAssets.Find(Path))
+	{
+		//one finished handle is enough to keep it loaded, the rest came from duplicate requests
+		for (int32 i = Cached->Handles.Num() - 1; i > 0; --i)
+		{
+			if (Cached->Handles[i]->HasLoadCompleted())
+			{
+				Cached->Handles[i]->ReleaseHandle();
+				Cached->Handles.RemoveAtSwap(i);
+			}
+		}
+	}
+
+	OnLoaded.ExecuteIfBound();
+	TrimCache();
+}
+
+void UAssetStreamingManager::TrimCache()
+{
+	while (CachedAssets.Num() > MaxCachedAssets)
+	{
+		const FSoftObjectPath* Oldest = nullptr;
+		double OldestTime = MAX_dbl;
+
+		for (const auto& Cached : CachedAssets)
+		{
+			bool bLoading = false;
+			for (const TSharedPtr<FStreamableHandle>& Handle : Cached.Value.Handles)
+			{
+				bLoading |= Handle->IsLoadingInProgress();
+			}
+
+			//never evict something still loading, someone is waiting on it
+			if (!bLoading && Cached.Value.LastUsedTime < OldestTime)
+			{
+				Oldest = &Cached.Key;
+				OldestTime = Cached.Value.LastUsedTime;
+			}
+		}
+
+		if (!Oldest)
+		{
+			return;
+		}
+
+		//only releases our hold on it, it stays loaded for as long as a component or widget still uses it
+		for (const TSharedPtr<FStreamableHandle>& Handle : CachedAssets[*Oldest].Handles)
+		{
+			Handle->ReleaseHandle();
+		}
+
+		CachedAssets.Remove(FSoftObjectPath(*Oldest));
+		DEC_DWORD_STAT(STAT_CachedStreamedAssets);
+	}
+}
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "AssetStreamingManager.generated.h"
+
+//How soon a request is needed, higher goes ahead in the async loading queue
+UENUM(BlueprintType)
+enum class EAssetStreamingPriority : uint8
+{
+	Background, //nice to have soon, ie instanced loot meshes in the distance
+	Normal, //UI that just opened
+	High //something the player is looking at right now, ie a pickup next to them
+};
+
+//An asset we've loaded, the handle keeps it in memory until it falls out of the cache
+struct FStreamedAsset
+{
+	TArray<TSharedPtr<FStreamableHandle>> Handles;
+
+	EAssetStreamingPriority Priority = EAssetStreamingPriority::Background;
+
+	double LastUsedTime = 0.0;
+};
+
+/**
+ * Loads soft referenced cosmetic assets (item meshes, thumbnails, widget classes) on demand.
+ * The most recently requested ones are kept loaded in a small LRU cache, anything older is only kept alive
+ * by whatever is still using it. Dedicated servers never load anything through here.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UAssetStreamingManager : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UAssetStreamingManager();
+
+	//Helper function to grab the streaming manager for the world an object lives in
+	static UAssetStreamingManager* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	//Load Path in the background and call OnLoaded once it's in, right away if it already is
+	//false if nothing is going to load (null path, dedicated server), OnLoaded is not called in that case
+	bool RequestAsset(const FSoftObjectPath& Path, EAssetStreamingPriority Priority, FSimpleDelegate OnLoaded = FSimpleDelegate());
+
+	//Same for several assets, OnLoaded is called once when all of them are in
+	bool RequestAssets(const TArray<FSoftObjectPath>& Paths, EAssetStreamingPriority Priority, FSimpleDelegate OnLoaded = FSimpleDelegate());
+
+	//Meshes, textures and UI are only any use where something renders
+	bool ShouldStreamCosmetics() const;
+
+	FORCEINLINE int32 GetNumCachedAssets() const { return CachedAssets.Num(); }
+
+protected:
+
+	//How many recently used assets to keep loaded even when nothing references them
+	UPROPERTY(Config)
+	int32 MaxCachedAssets;
+
+	static TAsyncLoadPriority GetLoadPriority(EAssetStreamingPriority Priority);
+
+	void OnAssetLoaded(FSoftObjectPath Path, FSimpleDelegate OnLoaded);
+
+	//Release the least recently used assets until the cache is back under MaxCachedAssets
+	void TrimCache();
+
+	FStreamableManager StreamableManager;
+
+	TMap<FSoftObjectPath, FStreamedAsset> CachedAssets;
+};
@@ -0,0 +1,373 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CharacterSignificanceManager.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "DrawDebugHelpers.h"
+#include "SurvivalCharacter.h"
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Critical"), STAT_SignificanceCritical, STATGROUP_SurvivalGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance High"), STAT_SignificanceHigh, STATGROUP_SurvivalGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Medium"), STAT_SignificanceMedium, STATGROUP_SurvivalGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Low"), STAT_SignificanceLow, STATGROUP_SurvivalGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Culled"), STAT_SignificanceCulled, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance Changes"), STAT_SignificanceChanges, STATGROUP_SurvivalGame);
+
+static TAutoConsoleVariable<int32> CVarSignificanceManager(
+	TEXT("survival.SignificanceManager"),
+	1,
+	TEXT("1 = other players tick and animate at a rate set by how significant they are (default)\n")
+	TEXT("0 = everyone runs at full rate"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarSignificanceDebug(
+	TEXT("survival.SignificanceDebug"),
+	0,
+	TEXT("1 = draw each managed character's significance bucket and score over its head\n")
+	TEXT("0 = off (default)"),
+	ECVF_Cheat);
+
+static FSignificanceBucketSettings MakeBucket(float MinScore, int32 MaxCharacters, float ActorTickInterval, float ComponentTickInterval, float MovementTickInterval, bool bTickComponents, bool bUpdateRateOptimizations, EVisibilityBasedAnimTickOption AnimTickOption)
+{
+	FSignificanceBucketSettings Bucket;
+	Bucket.MinScore = MinScore;
+	Bucket.MaxCharacters = MaxCharacters;
+	Bucket.ActorTickInterval = ActorTickInterval;
+	Bucket.ComponentTickInterval = ComponentTickInterval;
+	Bucket.MovementTickInterval = MovementTickInterval;
+	Bucket.bTickComponents = bTickComponents;
+	Bucket.bUpdateRateOptimizations = bUpdateRateOptimizations;
+	Bucket.AnimTickOption = AnimTickOption;
+	return Bucket;
+}
+
+UCharacterSignificanceManager::UCharacterSignificanceManager()
+{
+	UpdateInterval = 0.1f;
+	OffscreenScoreScale = 0.2f;
+	RecentlyRenderedTime = 0.2f;
+	TimeSinceUpdate = 0.f;
+
+	//score is roughly the fraction of the screen's height the character covers
+	Buckets.Add(MakeBucket(0.1f, 8, 0.f, 0.f, 0.f, true, false, EVisibilityBasedAnimTickOption::AlwaysTickPose)); //Critical
+	Buckets.Add(MakeBucket(0.03f, 16, 0.f, 0.f, 0.f, true, true, EVisibilityBasedAnimTickOption::AlwaysTickPose)); //High
+	Buckets.Add(MakeBucket(0.01f, 24, 0.1f, 0.033f, 0.033f, true, true, EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered)); //Medium
+	Buckets.Add(MakeBucket(0.002f, 32, 0.25f, 0.1f, 0.1f, true, true, EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered)); //Low
+	Buckets.Add(MakeBucket(0.f, 0, 1.f, 0.f, 0.25f, false, true, EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered)); //Culled
+}
+
+UCharacterSignificanceManager* UCharacterSignificanceManager::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		return UGameInstance::GetSubsystem<UCharacterSignificanceManager>(World->GetGameInstance());
+	}
+
+	return nullptr;
+}
+
+void UCharacterSignificanceManager::Deinitialize()
+{
+	ManagedCharacters.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCharacterSignificanceManager::RegisterCharacter(ASurvivalCharacter* Character)
+{
+	if (!Character || Character->GetNetMode() == NM_DedicatedServer)
+	{
+		return; //nothing renders, nothing to scale back
+	}
+
+	for (const FCharacterSignificance& Entry : ManagedCharacters)
+	{
+		if (Entry.Character == Character)
+		{
+			return;
+		}
+	}
+
+	FCharacterSignificance& Entry = ManagedCharacters.AddDefaulted_GetRef();
+	Entry.Character = Character;
+	Entry.DefaultActorTickInterval = Character->GetActorTickInterval();
+
+	if (USkeletalMeshComponent* Mesh = Character->GetMesh())
+	{
+		Entry.DefaultComponentTickInterval = Mesh->GetComponentTickInterval();
+		Entry.bDefaultUpdateRateOptimizations = Mesh->bEnableUpdateRateOptimizations;
+		Entry.DefaultAnimTickOption = Mesh->VisibilityBasedAnimTickOption;
+	}
+
+	if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
+	{
+		Entry.DefaultMovementTickInterval = Movement->GetComponentTickInterval();
+	}
+}
+
+void UCharacterSignificanceManager::UnregisterCharacter(ASurvivalCharacter* Character)
+{
+	ManagedCharacters.RemoveAllSwap([Character](const FCharacterSignificance& Entry)
+	{
+		return !Entry.Character.IsValid() || Entry.Character == Character;
+	});
+}
+
+ESignificanceBucket UCharacterSignificanceManager::GetBucket(const ASurvivalCharacter* Character) const
+{
+	for (const FCharacterSignificance& Entry : ManagedCharacters)
+	{
+		if (Entry.Character == Character)
+		{
+			return Entry.Bucket;
+		}
+	}
+
+	return ESignificanceBucket::MAX;
+}
+
+bool UCharacterSignificanceManager::ShouldManage(const ASurvivalCharacter* Character)
+{
+	//our own pawn and anything we simulate (remote players on a listen server) need their movement and animation every frame
+	return Character && Character->Role == ROLE_SimulatedProxy && CVarSignificanceManager.GetValueOnGameThread() != 0;
+}
+
+float UCharacterSignificanceManager::ScoreCharacter(const ASurvivalCharacter* Character, const TArray<FVector>& ViewLocations, float TanHalfFOV) const
+{
+	const USkeletalMeshComponent* Mesh = Character->GetMesh();
+	const float Radius = Mesh ? Mesh->Bounds.SphereRadius : Character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	const FVector Location = Character->GetActorLocation();
+
+	float Score = 0.f;
+
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		//radius over the half height of the view frustum at that distance
+		const float Distance = FVector::Dist(ViewLocation, Location);
+		Score = FMath::Max(Score, Radius / FMath::Max(Distance * TanHalfFOV, 1.f));
+	}
+
+	if (!Character->WasRecentlyRendered(RecentlyRenderedTime))
+	{
+		Score *= OffscreenScoreScale;
+	}
+
+	return Score;
+}
+
+void UCharacterSignificanceManager::UpdateSignificance(UWorld* World)
+{
+	//every local player's view counts, split screen players each see their own part of the world
+	TArray<FVector> ViewLocations;
+	float FOV = 0.f;
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (!PC || !PC->IsLocalController())
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		ViewLocations.Add(ViewLocation);
+
+		FOV = FMath::Max(FOV, PC->PlayerCameraManager ? PC->PlayerCameraManager->GetFOVAngle() : 90.f);
+	}
+
+	const float TanHalfFOV = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(FOV, 10.f, 170.f) * 0.5f));
+
+	//score everyone we manage, put anyone we don't back how they were
+	TArray<FCharacterSignificance*> Scored;
+	Scored.Reserve(ManagedCharacters.Num());
+
+	for (FCharacterSignificance& Entry : ManagedCharacters)
+	{
+		ASurvivalCharacter* Character = Entry.Character.Get();
+
+		if (!Character)
+		{
+			continue;
+		}
+
+		if (!ShouldManage(Character) || ViewLocations.Num() == 0)
+		{
+			RestoreDefaults(Entry);
+			continue;
+		}
+
+		Entry.Score = ScoreCharacter(Character, ViewLocations, TanHalfFOV);
+		Scored.Add(&Entry);
+	}
+
+	Scored.Sort([](const FCharacterSignificance& A, const FCharacterSignificance& B)
+	{
+		return A.Score > B.Score;
+	});
+
+	//fill buckets from the top, a full bucket pushes everyone after it down a level
+	int32 BucketCounts[(int32)ESignificanceBucket::MAX] = {};
+	int32 BucketIndex = 0;
+
+	for (FCharacterSignificance* Entry : Scored)
+	{
+		while (BucketIndex < (int32)ESignificanceBucket::Culled)
+		{
+			const FSignificanceBucketSettings& Settings = Buckets[BucketIndex];
+			const bool bFull = Settings.MaxCharacters > 0 && BucketCounts[BucketIndex] >= Settings.MaxCharacters;
+
+			if (!bFull && Entry->Score >= Settings.MinScore)
+			{
+				break;
+			}
+
+			++BucketIndex;
+		}
+
+		++BucketCounts[BucketIndex];
+		ApplyBucket(*Entry, (ESignificanceBucket)BucketIndex);
+	}
+
+	SET_DWORD_STAT(STAT_SignificanceCritical, BucketCounts[(int32)ESignificanceBucket::Critical]);
+	SET_DWORD_STAT(STAT_SignificanceHigh, BucketCounts[(int32)ESignificanceBucket::High]);
+	SET_DWORD_STAT(STAT_SignificanceMedium, BucketCounts[(int32)ESignificanceBucket::Medium]);
+	SET_DWORD_STAT(STAT_SignificanceLow, BucketCounts[(int32)ESignificanceBucket::Low]);
+	SET_DWORD_STAT(STAT_SignificanceCulled, BucketCounts[(int32)ESignificanceBucket::Culled]);
+}
+
+void UCharacterSignificanceManager::ApplyBucket(FCharacterSignificance& Entry, ESignificanceBucket Bucket) const
+{
+	if (Entry.Bucket == Bucket)
+	{
+		return; //most characters stay put between updates, setting tick intervals isn't free
+	}
+
+	ASurvivalCharacter* Character = Entry.Character.Get();
+	const FSignificanceBucketSettings& Settings = Buckets[(int32)Bucket];
+
+	Character->SetActorTickInterval(Settings.ActorTickInterval);
+
+	if (USkeletalMeshComponent* Mesh = Character->GetMesh())
+	{
+		Mesh->SetComponentTickInterval(Settings.ComponentTickInterval);
+		Mesh->SetComponentTickEnabled(Settings.bTickComponents);
+		Mesh->bEnableUpdateRateOptimizations = Settings.bUpdateRateOptimizations;
+		Mesh->VisibilityBasedAnimTickOption = Settings.AnimTickOption;
+	}
+
+	if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
+	{
+		Movement->SetComponentTickInterval(Settings.MovementTickInterval);
+	}
+
+	Entry.Bucket = Bucket;
+
+	SURVIVAL_INC_COUNTER(STAT_SignificanceChanges);
+}
+
+void UCharacterSignificanceManager::RestoreDefaults(FCharacterSignificance& Entry) const
+{
+	if (Entry.Bucket == ESignificanceBucket::MAX)
+	{
+		return;
+	}
+
+	ASurvivalCharacter* Character = Entry.Character.Get();
+
+	Character->SetActorTickInterval(Entry.DefaultActorTickInterval);
+
+	if (USkeletalMeshComponent* Mesh = Character->GetMesh())
+	{
+		Mesh->SetComponentTickInterval(Entry.DefaultComponentTickInterval);
+		Mesh->SetComponentTickEnabled(true);
+		Mesh->bEnableUpdateRateOptimizations = Entry.bDefaultUpdateRateOptimizations;
+		Mesh->VisibilityBasedAnimTickOption = Entry.DefaultAnimTickOption;
+	}
+
+	if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
+	{
+		Movement->SetComponentTickInterval(Entry.DefaultMovementTickInterval);
+	}
+
+	Entry.Bucket = ESignificanceBucket::MAX;
+}
+
+void UCharacterSignificanceManager::DrawDebug(UWorld* World) const
+{
+#if ENABLE_DRAW_DEBUG
+	static const FColor BucketColors[(int32)ESignificanceBucket::MAX] = { FColor::Red, FColor::Orange, FColor::Yellow, FColor::Green, FColor::Silver };
+
+	for (const FCharacterSignificance& Entry : ManagedCharacters)
+	{
+		const ASurvivalCharacter* Character = Entry.Character.Get();
+
+		if (!Character || Entry.Bucket == ESignificanceBucket::MAX)
+		{
+			continue;
+		}
+
+		const FString BucketName = StaticEnum<ESignificanceBucket>()->GetNameStringByValue((int64)Entry.Bucket);
+		const FVector TextLocation = Character->GetActorLocation() + FVector(0.f, 0.f, Character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight() + 20.f);
+
+		DrawDebugString(World, TextLocation, FString::Printf(TEXT("%s %.3f"), *BucketName, Entry.Score), nullptr, BucketColors[(int32)Entry.Bucket], 0.f, true);
+	}
+#endif
+}
+
+void UCharacterSignificanceManager::Tick(float DeltaTime)
+{
+	UWorld* World = GetTickableGameObjectWorld();
+
+	//characters destroyed without unregistering
+	ManagedCharacters.RemoveAllSwap([](const FCharacterSignificance& Entry)
+	{
+		return !Entry.Character.IsValid();
+	});
+
+	if (!World || Buckets.Num() != (int32)ESignificanceBucket::MAX)
+	{
+		return; //config is missing a bucket, leave everyone at full rate rather than guess
+	}
+
+	TimeSinceUpdate += DeltaTime;
+
+	if (TimeSinceUpdate >= UpdateInterval)
+	{
+		TimeSinceUpdate = 0.f;
+		UpdateSignificance(World);
+	}
+
+	if (CVarSignificanceDebug.GetValueOnGameThread() != 0)
+	{
+		DrawDebug(World);
+	}
+}
+
+bool UCharacterSignificanceManager::IsTickable() const
+{
+	return !UE_SERVER && ManagedCharacters.Num() > 0;
+}
+
+TStatId UCharacterSignificanceManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCharacterSignificanceManager, STATGROUP_Tickables);
+}
+
+UWorld* UCharacterSignificanceManager::GetTickableGameObjectWorld() const
+{
+	return GetGameInstance() ? GetGameInstance()->GetWorld() : nullptr;
+}
+
+ETickableTickType UCharacterSignificanceManager::GetTickableTickType() const
+{
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional; //CDO should never tick
+}
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "CharacterSignificanceManager.generated.h"
+
+//Most to least significant, every character on this machine is in exactly one
+UENUM(BlueprintType)
+enum class ESignificanceBucket : uint8
+{
+	Critical,
+	High,
+	Medium,
+	Low,
+	Culled, //offscreen or over every other bucket's budget
+
+	MAX UMETA(Hidden)
+};
+
+//What a character in a bucket is allowed to spend
+USTRUCT()
+struct FSignificanceBucketSettings
+{
+	GENERATED_BODY()
+
+	FSignificanceBucketSettings()
+	{
+		MinScore = 0.f;
+		MaxCharacters = 0;
+		ActorTickInterval = 0.f;
+		ComponentTickInterval = 0.f;
+		MovementTickInterval = 0.f;
+		bTickComponents = true;
+		bUpdateRateOptimizations = true;
+		AnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPose;
+	}
+
+	//Lowest score that gets into this bucket
+	UPROPERTY(Config)
+	float MinScore;
+
+	//Budget, once this many characters are in the bucket the rest drop to the next one. 0 = unlimited
+	UPROPERTY(Config)
+	int32 MaxCharacters;
+
+	UPROPERTY(Config)
+	float ActorTickInterval;
+
+	//Mesh tick interval
+	UPROPERTY(Config)
+	float ComponentTickInterval;
+
+	//Movement component tick interval. Movement is only ever slowed down, never stopped, it is what moves a simulated character
+	//to its replicated location, so one that stopped ticking would snap when it came back
+	UPROPERTY(Config)
+	float MovementTickInterval;
+
+	//false stops the mesh ticking at all
+	UPROPERTY(Config)
+	bool bTickComponents;
+
+	//Let the skeletal mesh skip animation frames depending on its screen size
+	UPROPERTY(Config)
+	bool bUpdateRateOptimizations;
+
+	UPROPERTY(Config)
+	EVisibilityBasedAnimTickOption AnimTickOption;
+};
+
+//Where a character was last put
+struct FCharacterSignificance
+{
+	TWeakObjectPtr<class ASurvivalCharacter> Character;
+
+	float Score = 0.f;
+
+	ESignificanceBucket Bucket = ESignificanceBucket::MAX; //MAX = nothing applied yet
+
+	//what the character had before we touched it, put back if it stops being managed
+	float DefaultActorTickInterval = 0.f;
+	float DefaultComponentTickInterval = 0.f;
+	float DefaultMovementTickInterval = 0.f;
+	bool bDefaultUpdateRateOptimizations = false;
+	EVisibilityBasedAnimTickOption DefaultAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+};
+
+/**
+ * Scores every remote (simulated) character by its screen size from the local players' views, scaled down when it wasn't rendered recently,
+ * and sorts them into buckets that each have a budget. A character's bucket decides how often it, its mesh and its movement tick
+ * and how much animation work its mesh does. Only runs where something renders, locally controlled and server owned characters are left alone.
+ * survival.SignificanceDebug 1 shows the bucket over each character.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UCharacterSignificanceManager : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UCharacterSignificanceManager();
+
+	//Helper function to grab the manager for the world an object lives in
+	static UCharacterSignificanceManager* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	void RegisterCharacter(class ASurvivalCharacter* Character);
+	void UnregisterCharacter(class ASurvivalCharacter* Character);
+
+	//MAX if the character isn't managed
+	ESignificanceBucket GetBucket(const class ASurvivalCharacter* Character) const;
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+
+protected:
+
+	//How often in seconds characters are rescored
+	UPROPERTY(Config)
+	float UpdateInterval;
+
+	//Score multiplier for characters that weren't rendered in the last RecentlyRenderedTime seconds
+	UPROPERTY(Config)
+	float OffscreenScoreScale;
+
+	UPROPERTY(Config)
+	float RecentlyRenderedTime;
+
+	//One per ESignificanceBucket, in order
+	UPROPERTY(Config)
+	TArray<FSignificanceBucketSettings> Buckets;
+
+	float TimeSinceUpdate;
+
+	TArray<FCharacterSignificance> ManagedCharacters;
+
+	//Characters this machine is only showing, everyone else is simulated/controlled here and has to run at full rate
+	static bool ShouldManage(const class ASurvivalCharacter* Character);
+
+	//Screen size from the closest local view, times OffscreenScoreScale if it hasn't been rendered
+	float ScoreCharacter(const class ASurvivalCharacter* Character, const TArray<FVector>& ViewLocations, float TanHalfFOV) const;
+
+	void UpdateSignificance(UWorld* World);
+	void ApplyBucket(FCharacterSignificance& Entry, ESignificanceBucket Bucket) const;
+
+	//Undo everything ApplyBucket did
+	void RestoreDefaults(FCharacterSignificance& Entry) const;
+	void DrawDebug(UWorld* World) const;
+};
@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GearMeshCache.h"
+#include "Engine/GameInstance.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/World.h"
+#include "SkeletalMeshMerge.h"
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gear Mesh Merges"), STAT_GearMeshMerges, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gear Mesh Cache Hits"), STAT_GearMeshCacheHits, STATGROUP_SurvivalGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Merged Gear Meshes"), STAT_MergedGearMeshes, STATGROUP_SurvivalGame);
+
+UGearMeshCache::UGearMeshCache()
+{
+	MaxCachedMeshes = 32;
+}
+
+UGearMeshCache* UGearMeshCache::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		return UGameInstance::GetSubsystem<UGearMeshCache>(World->GetGameInstance());
+	}
+
+	return nullptr;
+}
+
+void UGearMeshCache::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_MergedGearMeshes, MergedMeshes.Num());
+	MergedMeshes.Empty();
+
+	Super::Deinitialize();
+}
+
+uint32 UGearMeshCache::HashParts(const TArray<USkeletalMesh*>& Parts)
+{
+	uint32 Hash = 0;
+
+	for (const USkeletalMesh* Part : Parts) //order matters, it decides the section order of the merged mesh
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Part));
+	}
+
+	return Hash;
+}
+
+USkeletalMesh* UGearMeshCache::GetMergedMesh(const TArray<USkeletalMesh*>& Parts)
+{
+	if (Parts.Num() < 2 || !Parts[0])
+	{
+		return nullptr;
+	}
+
+	const uint32 Hash = HashParts(Parts);
+
+	if (FMergedGearMesh* Cached = MergedMeshes.Find(Hash))
+	{
+		if (Cached->Mesh && Cached->Parts == Parts)
+		{
+			SURVIVAL_INC_COUNTER(STAT_GearMeshCacheHits);
+
+			Cached->LastUsedTime = FPlatformTime::Seconds();
+			return Cached->Mesh;
+		}
+	}
+
+	USkeletalMesh* MergedMesh = MergeParts(Parts);
+	if (!MergedMesh)
+	{
+		return nullptr;
+	}
+
+	if (!MergedMeshes.Contains(Hash))
+	{
+		INC_DWORD_STAT(STAT_MergedGearMeshes);
+	}
+
+	//a collision just replaces the older combination, it's only a cache
+	FMergedGearMesh& NewEntry = MergedMeshes.Add(Hash);
+	NewEntry.Parts = Parts;
+	NewEntry.Mesh = MergedMesh;
+	NewEntry.LastUsedTime = FPlatformTime::Seconds();
+
+	TrimCache();
+
+	return MergedMesh;
+}
+
+USkeletalMesh* UGearMeshCache::MergeParts(const TArray<USkeletalMesh*>& Parts)
+{
+#if UE_SERVER
+	return nullptr;
+#else
+	for (const USkeletalMesh* Part : Parts)
+	{
+		if (!Part || Part->Skeleton != Parts[0]->Skeleton) //gear made for another skeleton can't share the body's bones
+		{
+			return nullptr;
+		}
+	}
+
+	SURVIVAL_INC_COUNTER(STAT_GearMeshMerges);
+
+	USkeletalMesh* MergedMesh = NewObject<USkeletalMesh>(this, NAME_None, RF_Transient);
+	MergedMesh->Skeleton = Parts[0]->Skeleton;
+
+	TArray<FSkelMeshMergeSectionMapping> SectionMappings; //no forced mapping, every part keeps its own sections and materials
+	FSkeletalMeshMerge Merger(MergedMesh, Parts, SectionMappings, 0);
+
+	if (!Merger.DoMerge())
+	{
+		UE_LOG(LogSurvivalGame, Warning, TEXT("GearMeshCache: failed to merge %d meshes onto %s, falling back to separate components"), Parts.Num(), *Parts[0]->GetName());
+		return nullptr;
+	}
+
+	//collision and ragdolls still come from the body
+	MergedMesh->PhysicsAsset = Parts[0]->PhysicsAsset;
+
+	return MergedMesh;
+#endif
+}
+
+void UGearMeshCache::TrimCache()
+{
+	while (MergedMeshes.Num() > MaxCachedMeshes)
+	{
+		uint32 OldestHash = 0;
+		double OldestTime = MAX_dbl;
+
+		for (const auto& Cached : MergedMeshes)
+		{
+			if (Cached.Value.LastUsedTime < OldestTime)
+			{
+				OldestHash = Cached.Key;
+				OldestTime = Cached.Value.LastUsedTime;
+			}
+		}
+
+		MergedMeshes.Remove(OldestHash);
+		DEC_DWORD_STAT(STAT_MergedGearMeshes);
+	}
+}
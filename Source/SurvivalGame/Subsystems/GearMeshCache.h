@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "GearMeshCache.generated.h"
+
+//One merged body + gear combination
+USTRUCT()
+struct FMergedGearMesh
+{
+	GENERATED_BODY()
+
+	FMergedGearMesh()
+	{
+		Mesh = nullptr;
+		LastUsedTime = 0.0;
+	}
+
+	//what was merged, in order, to tell hash collisions apart
+	UPROPERTY()
+	TArray<class USkeletalMesh*> Parts;
+
+	UPROPERTY()
+	class USkeletalMesh* Mesh;
+
+	double LastUsedTime;
+};
+
+/**
+ * Bakes a character's body and equipped gear into a single skeletal mesh, so each character renders, skins and updates bounds
+ * for one component instead of one per gear slot. Results are cached by the combination of meshes, everyone wearing
+ * the same loadout shares one merged mesh.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UGearMeshCache : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UGearMeshCache();
+
+	//Helper function to grab the cache for the world an object lives in
+	static UGearMeshCache* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	//Parts[0] is the body, the rest gear in slot order. All of them have to use the same skeleton
+	//null if they can't be merged, the caller should keep using separate components then
+	class USkeletalMesh* GetMergedMesh(const TArray<class USkeletalMesh*>& Parts);
+
+	FORCEINLINE int32 GetNumMergedMeshes() const { return MergedMeshes.Num(); }
+
+protected:
+
+	//How many combinations to keep around. A dropped one stays alive for as long as a character still wears it
+	UPROPERTY(Config)
+	int32 MaxCachedMeshes;
+
+	static uint32 HashParts(const TArray<class USkeletalMesh*>& Parts);
+
+	class USkeletalMesh* MergeParts(const TArray<class USkeletalMesh*>& Parts);
+
+	void TrimCache();
+
+	UPROPERTY()
+	TMap<uint32, FMergedGearMesh> MergedMeshes;
+};
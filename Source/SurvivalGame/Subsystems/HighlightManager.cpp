@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HighlightManager.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Highlight Requests"), STAT_HighlightRequests, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Highlights Applied"), STAT_HighlightsApplied, STATGROUP_SurvivalGame);
+
+UHighlightManager::UHighlightManager()
+{
+	FocusedStencilValue = 1;
+	InteractingStencilValue = 2;
+}
+
+UHighlightManager* UHighlightManager::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		return UGameInstance::GetSubsystem<UHighlightManager>(World->GetGameInstance());
+	}
+
+	return nullptr;
+}
+
+void UHighlightManager::Deinitialize()
+{
+	HighlightedActors.Empty();
+	DirtyActors.Empty();
+
+	Super::Deinitialize();
+}
+
+void UHighlightManager::SetHighlight(AActor* Actor, EInteractableHighlight State)
+{
+	if (!Actor)
+	{
+		return;
+	}
+
+	SURVIVAL_INC_COUNTER(STAT_HighlightRequests);
+
+	//clearing something we never outlined, e.g. a pooled pickup being reset, doesn't need an entry
+	if (State == EInteractableHighlight::None && !HighlightedActors.Contains(Actor))
+	{
+		return;
+	}
+
+	FHighlightedActor& Entry = HighlightedActors.FindOrAdd(Actor);
+
+	if (Entry.PendingState != State)
+	{
+		Entry.PendingState = State;
+		DirtyActors.AddUnique(Actor); //a few entries a frame at most, a linear check is fine
+	}
+}
+
+EInteractableHighlight UHighlightManager::GetHighlight(const AActor* Actor) const
+{
+	const FHighlightedActor* Entry = HighlightedActors.Find(Actor);
+	return Entry ? Entry->PendingState : EInteractableHighlight::None;
+}
+
+void UHighlightManager::ForgetActor(AActor* Actor)
+{
+	HighlightedActors.Remove(Actor);
+	DirtyActors.RemoveSingleSwap(Actor);
+}
+
+int32 UHighlightManager::GetStencilValue(EInteractableHighlight State) const
+{
+	switch (State)
+	{
+	case EInteractableHighlight::Focused:
+		return FocusedStencilValue;
+	case EInteractableHighlight::Interacting:
+		return InteractingStencilValue;
+	default:
+		return 0;
+	}
+}
+
+void UHighlightManager::ApplyHighlight(AActor* Actor, FHighlightedActor& Entry) const
+{
+	//focus went somewhere and came back within the frame, nothing to do
+	if (Entry.PendingState == Entry.AppliedState)
+	{
+		return;
+	}
+
+	TInlineComponentArray<UPrimitiveComponent*> Primitives(Actor);
+
+	const bool bOutlined = Entry.PendingState != EInteractableHighlight::None;
+	const int32 StencilValue = GetStencilValue(Entry.PendingState);
+
+	for (UPrimitiveComponent* Prim : Primitives)
+	{
+		if (bOutlined && Prim->CustomDepthStencilValue != StencilValue)
+		{
+			Prim->SetCustomDepthStencilValue(StencilValue);
+		}
+
+		if (Prim->bRenderCustomDepth != bOutlined)
+		{
+			Prim->SetRenderCustomDepth(bOutlined);
+		}
+	}
+
+	//anything outlined last time that the actor no longer has, still alive somewhere (detached, pooled) and still drawing it
+	for (const TWeakObjectPtr<UPrimitiveComponent>& WeakPrim : Entry.Primitives)
+	{
+		UPrimitiveComponent* Prim = WeakPrim.Get();
+		if (Prim && Prim->bRenderCustomDepth && !Primitives.Contains(Prim))
+		{
+			Prim->SetRenderCustomDepth(false);
+		}
+	}
+
+	Entry.Primitives.Reset();
+	if (bOutlined)
+	{
+		Entry.Primitives.Append(Primitives);
+	}
+
+	Entry.AppliedState = Entry.PendingState;
+
+	SURVIVAL_INC_COUNTER(STAT_HighlightsApplied);
+}
+
+void UHighlightManager::Tick(float DeltaTime)
+{
+	for (const TWeakObjectPtr<AActor>& WeakActor : DirtyActors)
+	{
+		AActor* Actor = WeakActor.Get();
+		FHighlightedActor* Entry = Actor ? HighlightedActors.Find(Actor) : nullptr;
+
+		if (Entry)
+		{
+			ApplyHighlight(Actor, *Entry);
+		}
+	}
+
+	DirtyActors.Reset();
+
+	//drop anything destroyed without telling us
+	for (auto It = HighlightedActors.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+bool UHighlightManager::IsTickable() const
+{
+	return !UE_SERVER && DirtyActors.Num() > 0;
+}
+
+TStatId UHighlightManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHighlightManager, STATGROUP_Tickables);
+}
+
+UWorld* UHighlightManager::GetTickableGameObjectWorld() const
+{
+	return GetGameInstance() ? GetGameInstance()->GetWorld() : nullptr;
+}
+
+ETickableTickType UHighlightManager::GetTickableTickType() const
+{
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional; //CDO should never tick
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "HighlightManager.generated.h"
+
+//Outline states, each one is drawn with its own custom depth stencil value so the post process can colour them differently
+UENUM(BlueprintType)
+enum class EInteractableHighlight : uint8
+{
+	None,
+	Focused,
+	Interacting
+};
+
+//An actor we have outlined at some point
+struct FHighlightedActor
+{
+	//the primitives the last applied state went on, so an outline can come off components the actor has since dropped
+	TArray<TWeakObjectPtr<class UPrimitiveComponent>> Primitives;
+
+	EInteractableHighlight AppliedState = EInteractableHighlight::None;
+	EInteractableHighlight PendingState = EInteractableHighlight::None;
+};
+
+/**
+ * Outlines interactables for the local player. Requests are collected during the frame and applied once in a batch,
+ * so focus flickering across a loot pile only touches render state for the actors whose final state actually changed.
+ * Custom depth is only switched on/off when an actor goes from no outline to some outline, moving between
+ * states just changes the stencil value. The actor's primitives are gathered when a change is applied, never cached,
+ * so components added or removed since (a lazily created widget, swapped gear) are always picked up.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UHighlightManager : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UHighlightManager();
+
+	//Helper function to grab the manager for the world an object lives in
+	static UHighlightManager* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	//Outline Actor in State from the end of this frame
+	void SetHighlight(AActor* Actor, EInteractableHighlight State);
+
+	//State Actor will have once this frame's batch is applied
+	EInteractableHighlight GetHighlight(const AActor* Actor) const;
+
+	//Drop everything cached for Actor, called when it leaves play
+	void ForgetActor(AActor* Actor);
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+
+protected:
+
+	//Stencil values the outline post process material reads
+	UPROPERTY(Config)
+	int32 FocusedStencilValue;
+
+	UPROPERTY(Config)
+	int32 InteractingStencilValue;
+
+	int32 GetStencilValue(EInteractableHighlight State) const;
+
+	void ApplyHighlight(AActor* Actor, FHighlightedActor& Entry) const;
+
+	TMap<TWeakObjectPtr<AActor>, FHighlightedActor> HighlightedActors;
+
+	//actors with a pending change this frame
+	TArray<TWeakObjectPtr<AActor>> DirtyActors;
+};
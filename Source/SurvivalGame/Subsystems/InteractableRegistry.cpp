@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractableRegistry.h"
+#include "Components/InteractionComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+UInteractableRegistry::UInteractableRegistry()
+{
+	CellSize = 500.f; //5 meters
+}
+
+UInteractableRegistry* UInteractableRegistry::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		return UGameInstance::GetSubsystem<UInteractableRegistry>(World->GetGameInstance());
+	}
+
+	return nullptr;
+}
+
+FIntPoint UInteractableRegistry::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+float UInteractableRegistry::GetInteractableRadius(const UInteractionComponent* Interactable)
+{
+	return Interactable->InteractionRadius;
+}
+
+void UInteractableRegistry::BumpRevision(const FIntPoint& Cell)
+{
+	++CellRevisions.FindOrAdd(Cell);
+}
+
+uint32 UInteractableRegistry::GetRevisionNear(const FVector& Location, float Radius) const
+{
+	const FIntPoint MinCell = GetCell(Location - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Location + FVector(Radius));
+
+	uint32 Revision = 0;
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			if (const uint32* CellRevision = CellRevisions.Find(FIntPoint(X, Y)))
+			{
+				Revision += *CellRevision;
+			}
+		}
+	}
+
+	return Revision;
+}
+
+void UInteractableRegistry::RegisterInteractable(UInteractionComponent* Interactable)
+{
+	if (!Interactable || CellLookup.Contains(Interactable)) //already registered, nothing to do
+	{
+		return;
+	}
+
+	const FVector Location = Interactable->GetComponentLocation();
+	const FIntPoint Cell = GetCell(Location);
+
+	Cells.FindOrAdd(Cell).Add({ Interactable, Location, GetInteractableRadius(Interactable) });
+	CellLookup.Add(Interactable, Cell);
+	BumpRevision(Cell);
+}
+
+void UInteractableRegistry::UnregisterInteractable(UInteractionComponent* Interactable)
+{
+	FIntPoint Cell;
+	if (!CellLookup.RemoveAndCopyValue(Interactable, Cell))
+	{
+		return;
+	}
+
+	BumpRevision(Cell);
+
+	if (TArray<FRegisteredInteractable>* CellEntries = Cells.Find(Cell))
+	{
+		CellEntries->RemoveAllSwap([Interactable](const FRegisteredInteractable& Entry) { return Entry.Interactable == Interactable; });
+
+		if (CellEntries->Num() == 0) //don't let empty cells pile up as things move around
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+void UInteractableRegistry::UpdateInteractable(UInteractionComponent* Interactable)
+{
+	FIntPoint* OldCell = CellLookup.Find(Interactable);
+	if (!OldCell)
+	{
+		return;
+	}
+
+	const FVector Location = Interactable->GetComponentLocation();
+	const FIntPoint NewCell = GetCell(Location);
+
+	if (NewCell != *OldCell) //left the cell, move it over
+	{
+		UnregisterInteractable(Interactable);
+		RegisterInteractable(Interactable);
+		return;
+	}
+
+	for (FRegisteredInteractable& Entry : Cells.FindChecked(NewCell)) //same cell, just refresh the cached data
+	{
+		if (Entry.Interactable == Interactable)
+		{
+			if (!Entry.Location.Equals(Location)) //transform updates without a real move (scale etc) don't count as a change
+			{
+				Entry.Location = Location;
+				BumpRevision(NewCell);
+			}
+
+			Entry.Radius = GetInteractableRadius(Interactable);
+			break;
+		}
+	}
+}
+
+UInteractionComponent* UInteractableRegistry::FindBestInteractable(const FVector& ViewLocation, const FVector& ViewDirection, float MaxDistance, float ConeHalfAngle, const AActor* IgnoredActor) const
+{
+	const float TanCone = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(ConeHalfAngle, 0.f, 89.f)));
+	const FIntPoint MinCell = GetCell(ViewLocation - FVector(MaxDistance));
+	const FIntPoint MaxCell = GetCell(ViewLocation + FVector(MaxDistance));
+
+	UInteractionComponent* BestInteractable = nullptr;
+	float BestScore = MAX_FLT;
+	float BestAlong = MAX_FLT;
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			const TArray<FRegisteredInteractable>* CellEntries = Cells.Find(FIntPoint(X, Y));
+			if (!CellEntries)
+			{
+				continue;
+			}
+
+			for (const FRegisteredInteractable& Entry : *CellEntries)
+			{
+				const FVector ToInteractable = Entry.Location - ViewLocation;
+				const float Along = FVector::DotProduct(ToInteractable, ViewDirection); //distance along the view ray
+
+				if (Along <= 0.f) //behind the camera
+				{
+					continue;
+				}
+
+				//distance to the surface of the object rather than its center, same as the old trace measured to the impact point
+				const float Distance = FMath::Max(ToInteractable.Size() - Entry.Radius, 0.f);
+				if (Distance > FMath::Min(MaxDistance, Entry.Interactable->InteractionDistance))
+				{
+					continue;
+				}
+
+				//how far the object sits off the view ray, anything whose bounds touch the ray scores 0
+				const float OffAxis = FMath::Sqrt(FMath::Max(ToInteractable.SizeSquared() - FMath::Square(Along), 0.f));
+				const float Miss = FMath::Max(OffAxis - Entry.Radius, 0.f);
+				if (Miss > Along * TanCone) //outside the cone
+				{
+					continue;
+				}
+
+				const float Score = Miss / Along;
+				if ((Score < BestScore || (Score == BestScore && Along < BestAlong)) && Entry.Interactable->GetOwner() != IgnoredActor)
+				{
+					BestInteractable = Entry.Interactable;
+					BestScore = Score;
+					BestAlong = Along;
+				}
+			}
+		}
+	}
+
+	return BestInteractable;
+}
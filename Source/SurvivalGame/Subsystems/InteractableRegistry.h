@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "InteractableRegistry.generated.h"
+
+//Cached copy of what the focus check needs from an interactable, kept in the grid so a query doesn't touch the component itself
+struct FRegisteredInteractable
+{
+	class UInteractionComponent* Interactable;
+
+	FVector Location;
+
+	//the interactable's InteractionRadius, lets big objects be focused from their edges and not just their center
+	float Radius;
+};
+
+/**
+ * World-level registry of every active interaction component, bucketed into a uniform 2D grid.
+ * Replaces tracing the whole scene every frame: the focus check asks the grid what is inside the view cone
+ * and only traces to confirm the single best candidate is visible.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UInteractableRegistry : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UInteractableRegistry();
+
+	//Helper function to grab the registry for the world an object lives in, null if there is no game instance (editor previews etc)
+	static UInteractableRegistry* Get(const UObject* WorldContextObject);
+
+	//Called by interaction components when they activate/deactivate
+	void RegisterInteractable(class UInteractionComponent* Interactable);
+	void UnregisterInteractable(class UInteractionComponent* Interactable);
+
+	//Refresh the cached location, only moves the entry between cells when it actually leaves its old one
+	void UpdateInteractable(class UInteractionComponent* Interactable);
+
+	//Returns the interactable nearest the center of the view cone that is also within its own InteractionDistance
+	//Does NOT check visibility, the caller confirms the result with a single trace
+	class UInteractionComponent* FindBestInteractable(const FVector& ViewLocation, const FVector& ViewDirection, float MaxDistance, float ConeHalfAngle, const AActor* IgnoredActor = nullptr) const;
+
+	//Sum of the change counters of every cell a query of this size would touch
+	//if it's the same as last time nothing nearby was added, removed or moved, so the result of the query can't have changed
+	uint32 GetRevisionNear(const FVector& Location, float Radius) const;
+
+	FORCEINLINE int32 GetNumInteractables() const { return CellLookup.Num(); }
+
+protected:
+
+	//Size of a grid cell in cm. Should be around the typical InteractionDistance so a query only touches a handful of cells
+	UPROPERTY(Config)
+	float CellSize;
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	static float GetInteractableRadius(const class UInteractionComponent* Interactable);
+
+	void BumpRevision(const FIntPoint& Cell);
+
+	TMap<FIntPoint, TArray<FRegisteredInteractable>> Cells;
+
+	//which cell each interactable lives in, so updates/removals don't have to search the grid
+	TMap<class UInteractionComponent*, FIntPoint> CellLookup;
+
+	//per cell change counters, kept even when a cell empties so the sums in GetRevisionNear only ever go up
+	TMap<FIntPoint, uint32> CellRevisions;
+};
@@ -0,0 +1,199 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractionCheckSubsystem.h"
+#include "SurvivalCharacter.h"
+#include "Components/InteractionComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interaction Checks"), STAT_InteractionChecks, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interaction Checks Skipped"), STAT_InteractionChecksSkipped, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interaction Traces"), STAT_InteractionTraces, STATGROUP_SurvivalGame);
+
+DECLARE_CYCLE_STAT(TEXT("Interaction Check Batch"), STAT_InteractionCheckBatch, STATGROUP_SurvivalGame);
+
+uint64 UInteractionCheckSubsystem::TotalChecksPerformed = 0;
+uint64 UInteractionCheckSubsystem::TotalChecksSkipped = 0;
+
+static FAutoConsoleCommand InteractionCheckStatsCommand(
+	TEXT("survival.InteractionCheckStats"),
+	TEXT("Prints how many interaction checks were performed and how many adaptive scheduling skipped. Pass 'reset' to zero the totals."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&UInteractionCheckSubsystem::PrintInteractionCheckStats));
+
+UInteractionCheckSubsystem* UInteractionCheckSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		return UGameInstance::GetSubsystem<UInteractionCheckSubsystem>(World->GetGameInstance());
+	}
+
+	return nullptr;
+}
+
+void UInteractionCheckSubsystem::Deinitialize()
+{
+	Characters.Empty();
+	PendingTraces.Empty();
+
+	Super::Deinitialize();
+}
+
+void UInteractionCheckSubsystem::RegisterCharacter(ASurvivalCharacter* Character)
+{
+	Characters.AddUnique(Character);
+}
+
+void UInteractionCheckSubsystem::UnregisterCharacter(ASurvivalCharacter* Character)
+{
+	Characters.RemoveSingleSwap(Character);
+	PendingTraces.RemoveAllSwap([Character](const FPendingInteractionTrace& Pending) { return Pending.Character == Character; });
+}
+
+void UInteractionCheckSubsystem::RecordInteractionCheck(bool bSkipped)
+{
+	if (bSkipped)
+	{
+		SURVIVAL_INC_COUNTER(STAT_InteractionChecksSkipped);
+		++TotalChecksSkipped;
+	}
+	else
+	{
+		SURVIVAL_INC_COUNTER(STAT_InteractionChecks);
+		++TotalChecksPerformed;
+	}
+}
+
+void UInteractionCheckSubsystem::RecordInteractionTrace()
+{
+	SURVIVAL_INC_COUNTER(STAT_InteractionTraces);
+}
+
+void UInteractionCheckSubsystem::PrintInteractionCheckStats(const TArray<FString>& Args)
+{
+	const uint64 TotalChecks = TotalChecksPerformed + TotalChecksSkipped;
+	const double SkippedPercent = TotalChecks > 0 ? 100.0 * TotalChecksSkipped / TotalChecks : 0.0;
+
+	UE_LOG(LogSurvivalGame, Display, TEXT("Interaction checks: %llu performed, %llu skipped (%.1f%% saved by adaptive scheduling)"), TotalChecksPerformed, TotalChecksSkipped, SkippedPercent);
+
+	if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+	{
+		TotalChecksPerformed = 0;
+		TotalChecksSkipped = 0;
+	}
+}
+
+void UInteractionCheckSubsystem::Tick(float DeltaTime)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InteractionCheckBatch);
+
+	UWorld* World = GetTickableGameObjectWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	//results first so a character whose trace just came back can be queued again this frame
+	ResolvePendingTraces(World);
+	QueueInteractionChecks(World);
+
+	//we tick whenever there is a character around, so this is where the interactor count goes to the CSV every frame
+	CSV_CUSTOM_STAT(SurvivalGame, ActiveInteractors, UInteractionComponent::GetNumActiveInteractors(), ECsvCustomStatOp::Set);
+}
+
+void UInteractionCheckSubsystem::ResolvePendingTraces(UWorld* World)
+{
+	for (const FPendingInteractionTrace& Pending : PendingTraces)
+	{
+		ASurvivalCharacter* Character = Pending.Character.Get();
+		if (!Character)
+		{
+			continue;
+		}
+
+		FTraceDatum TraceData;
+		if (!World->QueryTraceData(Pending.Handle, TraceData)) //result expired, character will just be checked again next time it is due
+		{
+			continue;
+		}
+
+		UInteractionComponent* Candidate = Pending.Candidate.Get();
+		bool bVisible = Candidate && Candidate->IsActive();
+
+		if (bVisible && TraceData.OutHits.Num() > 0 && TraceData.OutHits[0].bBlockingHit)
+		{
+			bVisible = TraceData.OutHits[0].GetActor() == Candidate->GetOwner(); //hit the object itself, nothing in the way
+		}
+
+		Character->ResolveInteractionCheck(bVisible ? Candidate : nullptr);
+	}
+
+	PendingTraces.Reset();
+}
+
+void UInteractionCheckSubsystem::QueueInteractionChecks(UWorld* World)
+{
+	for (int32 i = Characters.Num() - 1; i >= 0; --i)
+	{
+		ASurvivalCharacter* Character = Characters[i];
+
+		if (!Character || Character->IsPendingKill())
+		{
+			Characters.RemoveAtSwap(i);
+			continue;
+		}
+
+		const EInteractionCheckSchedule Schedule = Character->GetInteractionCheckSchedule();
+
+		if (Schedule != EInteractionCheckSchedule::Due)
+		{
+			if (Schedule == EInteractionCheckSchedule::Skipped)
+			{
+				RecordInteractionCheck(true);
+			}
+
+			continue;
+		}
+
+		RecordInteractionCheck(false);
+
+		FVector EyesLoc;
+		UInteractionComponent* Candidate = Character->FindInteractionCandidate(EyesLoc);
+
+		if (!Candidate) //nothing in front of us, no trace needed
+		{
+			Character->ResolveInteractionCheck(nullptr);
+			continue;
+		}
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(InteractionVisibility), false, Character);
+		RecordInteractionTrace();
+
+		FPendingInteractionTrace& Pending = PendingTraces.AddDefaulted_GetRef();
+		Pending.Character = Character;
+		Pending.Candidate = Candidate;
+		Pending.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, EyesLoc, Candidate->GetComponentLocation(), ECC_Visibility, QueryParams);
+	}
+}
+
+bool UInteractionCheckSubsystem::IsTickable() const
+{
+	return Characters.Num() > 0 || PendingTraces.Num() > 0;
+}
+
+TStatId UInteractionCheckSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInteractionCheckSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UInteractionCheckSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetGameInstance() ? GetGameInstance()->GetWorld() : nullptr;
+}
+
+ETickableTickType UInteractionCheckSubsystem::GetTickableTickType() const
+{
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional; //CDO should never tick
+}
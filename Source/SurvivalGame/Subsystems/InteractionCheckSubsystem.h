@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "InteractionCheckSubsystem.generated.h"
+
+//A visibility trace we sent off last frame, waiting on its result
+struct FPendingInteractionTrace
+{
+	TWeakObjectPtr<class ASurvivalCharacter> Character;
+
+	TWeakObjectPtr<class UInteractionComponent> Candidate;
+
+	FTraceHandle Handle;
+};
+
+/**
+ * Runs the interaction check for every character in the world from one place, once per frame.
+ * Candidates come from the interactable registry on the game thread, the confirming visibility traces are all
+ * sent through AsyncLineTraceByChannel together and their results handed back to the characters next frame.
+ * Characters registered here don't need to tick at all.
+ */
+UCLASS()
+class SURVIVALGAME_API UInteractionCheckSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	//Helper function to grab the subsystem for the world an object lives in
+	static UInteractionCheckSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	void RegisterCharacter(class ASurvivalCharacter* Character);
+	void UnregisterCharacter(class ASurvivalCharacter* Character);
+
+	//Counts a check (or one adaptive scheduling skipped) towards 'stat SurvivalGame' and the totals printed by survival.InteractionCheckStats
+	static void RecordInteractionCheck(bool bSkipped);
+
+	//Counts a visibility trace for an interaction check, async or not
+	static void RecordInteractionTrace();
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+
+protected:
+
+	//Hand last frame's trace results back to their characters
+	void ResolvePendingTraces(UWorld* World);
+
+	//Gather this frame's queries and send the traces off
+	void QueueInteractionChecks(UWorld* World);
+
+	UPROPERTY()
+	TArray<class ASurvivalCharacter*> Characters;
+
+	TArray<FPendingInteractionTrace> PendingTraces;
+
+	//running totals since startup (or the last survival.InteractionCheckStats reset), shared by every world
+	static uint64 TotalChecksPerformed;
+	static uint64 TotalChecksSkipped;
+
+	static void PrintInteractionCheckStats(const TArray<FString>& Args);
+};
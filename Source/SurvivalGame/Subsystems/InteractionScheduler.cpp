@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractionScheduler.h"
+#include "SurvivalCharacter.h"
+#include "Components/InteractionComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Timed Interactions"), STAT_TimedInteractions, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Timed Interactions Completed"), STAT_TimedInteractionsCompleted, STATGROUP_SurvivalGame);
+
+UInteractionScheduler::UInteractionScheduler()
+{
+	SlotDuration = 0.05f;
+	WheelSize = 256; //a bit under 13 seconds per turn
+	ProcessedTick = 0;
+	NextSerial = 0;
+}
+
+UInteractionScheduler* UInteractionScheduler::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		return UGameInstance::GetSubsystem<UInteractionScheduler>(World->GetGameInstance());
+	}
+
+	return nullptr;
+}
+
+void UInteractionScheduler::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SlotDuration = FMath::Max(SlotDuration, 0.001f);
+	Wheel.SetNum(FMath::Max(WheelSize, 1));
+}
+
+void UInteractionScheduler::Deinitialize()
+{
+	Sessions.Empty();
+	Wheel.Empty();
+	SET_DWORD_STAT(STAT_TimedInteractions, 0);
+
+	Super::Deinitialize();
+}
+
+float UInteractionScheduler::GetTime() const
+{
+	UWorld* World = GetTickableGameObjectWorld();
+	return World ? World->GetTimeSeconds() : 0.f;
+}
+
+int64 UInteractionScheduler::GetTick(float Time) const
+{
+	return FMath::FloorToInt(Time / SlotDuration);
+}
+
+void UInteractionScheduler::BeginSession(ASurvivalCharacter* Character, UInteractionComponent* Interactable, float Duration)
+{
+	if (!Character || Wheel.Num() == 0)
+	{
+		return;
+	}
+
+	const float Now = GetTime();
+
+	if (Sessions.Num() == 0) //the wheel hasn't been turning while there was nothing to do, catch it up
+	{
+		ProcessedTick = GetTick(Now) - 1;
+	}
+
+	FInteractionSession& Session = Sessions.FindOrAdd(Character); //any older session's wheel entry is now stale and gets skipped
+	Session.Interactable = Interactable;
+	Session.StartTime = Now;
+	Session.EndTime = Now + FMath::Max(Duration, 0.f);
+	Session.Serial = NextSerial++;
+
+	const int64 EndTick = FMath::Max(GetTick(Session.EndTime), ProcessedTick + 1);
+	Wheel[EndTick % Wheel.Num()].Add({ Character, Session.Serial });
+
+	SET_DWORD_STAT(STAT_TimedInteractions, Sessions.Num());
+}
+
+void UInteractionScheduler::EndSession(ASurvivalCharacter* Character)
+{
+	//the wheel entry is left behind and dropped when its slot comes round, cheaper than searching for it now
+	Sessions.Remove(Character);
+
+	SET_DWORD_STAT(STAT_TimedInteractions, Sessions.Num());
+}
+
+bool UInteractionScheduler::IsInteracting(const ASurvivalCharacter* Character) const
+{
+	return Sessions.Contains(Character);
+}
+
+float UInteractionScheduler::GetRemainingTime(const ASurvivalCharacter* Character) const
+{
+	const FInteractionSession* Session = Sessions.Find(Character);
+	return Session ? FMath::Max(Session->EndTime - GetTime(), 0.f) : 0.f;
+}
+
+float UInteractionScheduler::GetProgress(const ASurvivalCharacter* Character, const UInteractionComponent* Interactable) const
+{
+	const FInteractionSession* Session = Sessions.Find(Character);
+	if (!Session || (Interactable && Session->Interactable != Interactable))
+	{
+		return 0.f;
+	}
+
+	const float Duration = Session->EndTime - Session->StartTime;
+	return Duration > 0.f ? FMath::Clamp((GetTime() - Session->StartTime) / Duration, 0.f, 1.f) : 1.f;
+}
+
+void UInteractionScheduler::Tick(float DeltaTime)
+{
+	const float Now = GetTime();
+	const int64 CurrentTick = GetTick(Now);
+
+	//after a long hitch there's no point going round the wheel more than once
+	const int64 FirstTick = FMath::Max(ProcessedTick + 1, CurrentTick - Wheel.Num() + 1);
+
+	TArray<ASurvivalCharacter*> Completed;
+
+	for (int64 Tick = FirstTick; Tick <= CurrentTick; ++Tick)
+	{
+		TArray<FScheduledInteraction>& Slot = Wheel[Tick % Wheel.Num()];
+
+		for (int32 i = Slot.Num() - 1; i >= 0; --i)
+		{
+			const FScheduledInteraction& Scheduled = Slot[i];
+			const FInteractionSession* Session = Sessions.Find(Scheduled.Character);
+
+			if (!Session || Session->Serial != Scheduled.Serial) //ended or replaced since it was scheduled
+			{
+				Slot.RemoveAtSwap(i, 1, false);
+			}
+			else if (Session->EndTime <= Now)
+			{
+				Completed.Add(Scheduled.Character);
+				Slot.RemoveAtSwap(i, 1, false);
+			}
+			//otherwise it ends later this slot, or on a later turn of the wheel
+		}
+	}
+
+	ProcessedTick = CurrentTick - 1;
+
+	//finish them after walking the wheel, Interact can start new sessions
+	for (ASurvivalCharacter* Character : Completed)
+	{
+		Sessions.Remove(Character);
+
+		if (Character && !Character->IsPendingKill())
+		{
+			Character->Interact();
+		}
+
+		SURVIVAL_INC_COUNTER(STAT_TimedInteractionsCompleted);
+	}
+
+	SET_DWORD_STAT(STAT_TimedInteractions, Sessions.Num());
+}
+
+bool UInteractionScheduler::IsTickable() const
+{
+	return Sessions.Num() > 0;
+}
+
+TStatId UInteractionScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInteractionScheduler, STATGROUP_Tickables);
+}
+
+UWorld* UInteractionScheduler::GetTickableGameObjectWorld() const
+{
+	return GetGameInstance() ? GetGameInstance()->GetWorld() : nullptr;
+}
+
+ETickableTickType UInteractionScheduler::GetTickableTickType() const
+{
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional; //CDO should never tick
+}
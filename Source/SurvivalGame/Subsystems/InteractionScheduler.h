@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "InteractionScheduler.generated.h"
+
+//One character holding interact on one component
+struct FInteractionSession
+{
+	TWeakObjectPtr<class UInteractionComponent> Interactable;
+
+	float StartTime;
+	float EndTime;
+
+	//tells this session apart from an older one of the same character that may still sit in the wheel
+	uint32 Serial;
+};
+
+//What the wheel stores, the session itself stays in the map
+struct FScheduledInteraction
+{
+	class ASurvivalCharacter* Character;
+
+	uint32 Serial;
+};
+
+/**
+ * Runs every timed interaction in the world (looting, searching, bandaging...) from one place instead of a timer per character.
+ * Sessions are kept with their start/end time so progress is a subtraction, and bucketed into a timing wheel by end time
+ * so each frame only looks at the interactions finishing around now.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UInteractionScheduler : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UInteractionScheduler();
+
+	//Helper function to grab the scheduler for the world an object lives in
+	static UInteractionScheduler* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	//Character->Interact() is called once Duration has passed, unless the session is ended first. Replaces any session the character had
+	void BeginSession(class ASurvivalCharacter* Character, class UInteractionComponent* Interactable, float Duration);
+	void EndSession(class ASurvivalCharacter* Character);
+
+	bool IsInteracting(const class ASurvivalCharacter* Character) const;
+
+	//0 if the character isn't interacting
+	float GetRemainingTime(const class ASurvivalCharacter* Character) const;
+
+	//0-1 through the character's current interaction, 0 if it isn't interacting (with Interactable, if one is given)
+	float GetProgress(const class ASurvivalCharacter* Character, const class UInteractionComponent* Interactable = nullptr) const;
+
+	FORCEINLINE int32 GetNumSessions() const { return Sessions.Num(); }
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+
+protected:
+
+	//Length of one wheel slot in seconds, interactions complete within a frame of their end time whatever this is
+	UPROPERTY(Config)
+	float SlotDuration;
+
+	//Number of slots. Interactions longer than SlotDuration * WheelSize just stay in their slot for more than one turn
+	UPROPERTY(Config)
+	int32 WheelSize;
+
+	float GetTime() const;
+	int64 GetTick(float Time) const;
+
+	TMap<class ASurvivalCharacter*, FInteractionSession> Sessions;
+
+	TArray<TArray<FScheduledInteraction>> Wheel;
+
+	//every slot before this has been emptied of anything due, the current slot is scanned again each frame
+	int64 ProcessedTick;
+
+	uint32 NextSerial;
+};
@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemRegistry.h"
+#include "Items/ItemDefinition.h"
+#include "Engine/AssetManager.h"
+#include "Engine/Engine.h"
+#include "UObject/CoreNet.h"
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Item Registry Sync Loads"), STAT_ItemRegistrySyncLoads, STATGROUP_SurvivalGame);
+
+const FPrimaryAssetType UItemRegistry::ItemAssetType = TEXT("Item");
+const FName UItemRegistry::UIBundle = TEXT("UI");
+const FName UItemRegistry::WorldBundle = TEXT("World");
+
+UItemRegistry::UItemRegistry()
+{
+	ItemScanPaths.Add(TEXT("/Game"));
+}
+
+UItemRegistry* UItemRegistry::Get()
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UItemRegistry>() : nullptr;
+}
+
+void UItemRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	//the asset registry has to finish its first scan before we can list anything
+	UAssetManager::CallOrRegister_OnCompletedInitialScan(FSimpleMulticastDelegate::FDelegate::CreateUObject(this, &UItemRegistry::BuildRegistry));
+}
+
+void UItemRegistry::Deinitialize()
+{
+	if (PreloadHandle.IsValid())
+	{
+		PreloadHandle->ReleaseHandle();
+		PreloadHandle.Reset();
+	}
+
+	ItemPaths.Empty();
+	IdsByName.Empty();
+
+	Super::Deinitialize();
+}
+
+void UItemRegistry::BuildRegistry()
+{
+	if (!UAssetManager::IsValid())
+	{
+		UE_LOG(LogSurvivalGame, Warning, TEXT("ItemRegistry: no asset manager, items will replicate as object references"));
+		return;
+	}
+
+	UAssetManager& AssetManager = UAssetManager::Get();
+	AssetManager.ScanPathsForPrimaryAssets(ItemAssetType, ItemScanPaths, UItemDefinition::StaticClass(), false, false, true);
+
+	TArray<FAssetData> ItemAssets;
+	AssetManager.GetPrimaryAssetDataList(ItemAssetType, ItemAssets);
+
+	ItemAssets.Sort([](const FAssetData& A, const FAssetData& B) { return A.AssetName.ToString() < B.AssetName.ToString(); });
+
+	ItemPaths.Reset();
+	ItemPaths.AddDefaulted(); //id 0 means no item
+	IdsByName.Reset();
+
+	TArray<const FAssetData*> Unnumbered;
+
+	//first everything with a fixed id, those must not move as the catalogue grows
+	for (const FAssetData& ItemAsset : ItemAssets)
+	{
+		int32 FixedId = 0;
+		ItemAsset.GetTagValue(GET_MEMBER_NAME_CHECKED(UItemDefinition, ItemId), FixedId);
+
+		if (FixedId <= 0 || FixedId > MAX_uint16)
+		{
+			Unnumbered.Add(&ItemAsset);
+			continue;
+		}
+
+		if (ItemPaths.Num() <= FixedId)
+		{
+			ItemPaths.SetNum(FixedId + 1);
+		}
+
+		if (!ItemPaths[FixedId].IsNull())
+		{
+			UE_LOG(LogSurvivalGame, Warning, TEXT("ItemRegistry: %s and %s both use item id %d, %s gets a generated one"),
+				*ItemPaths[FixedId].ToString(), *ItemAsset.ObjectPath.ToString(), FixedId, *ItemAsset.AssetName.ToString());
+
+			Unnumbered.Add(&ItemAsset);
+			continue;
+		}
+
+		ItemPaths[FixedId] = ItemAsset.ToSoftObjectPath();
+		IdsByName.Add(ItemAsset.AssetName, (uint16)FixedId);
+	}
+
+	//then the rest in name order after the highest fixed id
+	for (const FAssetData* ItemAsset : Unnumbered)
+	{
+		if (ItemPaths.Num() > MAX_uint16)
+		{
+			UE_LOG(LogSurvivalGame, Warning, TEXT("ItemRegistry: out of item ids, %s will replicate as an object reference"), *ItemAsset->AssetName.ToString());
+			continue;
+		}
+
+		IdsByName.Add(ItemAsset->AssetName, (uint16)ItemPaths.Num());
+		ItemPaths.Add(ItemAsset->ToSoftObjectPath());
+	}
+
+	//gameplay data only, presentation is in bundles that are streamed when something needs it
+	TArray<FPrimaryAssetId> ItemAssetIds;
+	AssetManager.GetPrimaryAssetIdList(ItemAssetType, ItemAssetIds);
+	PreloadHandle = AssetManager.LoadPrimaryAssets(ItemAssetIds, TArray<FName>());
+}
+
+void UItemRegistry::GetItemIds(TArray<uint16>& OutItemIds) const
+{
+	IdsByName.GenerateValueArray(OutItemIds);
+}
+
+uint16 UItemRegistry::GetItemId(const UItemDefinition* Definition)
+{
+	const UItemRegistry* Registry = Definition ? Get() : nullptr;
+	const uint16* ItemId = Registry ? Registry->IdsByName.Find(Definition->GetFName()) : nullptr;
+
+	//the name alone isn't unique across folders, make sure it's really the one we registered
+	if (ItemId && Registry->ItemPaths[*ItemId] == FSoftObjectPath(Definition))
+	{
+		return *ItemId;
+	}
+
+	return 0;
+}
+
+UItemDefinition* UItemRegistry::FindDefinition(uint16 ItemId)
+{
+	const UItemRegistry* Registry = ItemId != 0 ? Get() : nullptr;
+	if (!Registry || !Registry->ItemPaths.IsValidIndex(ItemId))
+	{
+		return nullptr;
+	}
+
+	const FSoftObjectPath& ItemPath = Registry->ItemPaths[ItemId];
+
+	if (UObject* Loaded = ItemPath.ResolveObject())
+	{
+		return Cast<UItemDefinition>(Loaded);
+	}
+
+	SURVIVAL_INC_COUNTER(STAT_ItemRegistrySyncLoads); //the preload hasn't got to it yet
+	return Cast<UItemDefinition>(ItemPath.TryLoad());
+}
+
+void UItemRegistry::NetSerializeDefinition(FArchive& Ar, UPackageMap* Map, UItemDefinition*& Definition)
+{
+	uint16 ItemId = Ar.IsSaving() ? GetItemId(Definition) : 0;
+	Ar << ItemId;
+
+	if (ItemId != 0)
+	{
+		if (Ar.IsLoading())
+		{
+			Definition = FindDefinition(ItemId);
+		}
+
+		return;
+	}
+
+	//not registered (or null), same as an ordinary object property
+	UObject* Object = Definition;
+	Map->SerializeObject(Ar, UItemDefinition::StaticClass(), Object);
+
+	if (Ar.IsLoading())
+	{
+		Definition = Cast<UItemDefinition>(Object);
+	}
+}
+
+TSharedPtr<FStreamableHandle> UItemRegistry::LoadItems(const TArray<uint16>& ItemIds, const TArray<FName>& Bundles, FStreamableDelegate Delegate)
+{
+	if (!UAssetManager::IsValid())
+	{
+		return nullptr;
+	}
+
+	TArray<FPrimaryAssetId> AssetIds;
+
+	for (const uint16 ItemId : ItemIds)
+	{
+		if (ItemPaths.IsValidIndex(ItemId) && !ItemPaths[ItemId].IsNull())
+		{
+			AssetIds.Add(FPrimaryAssetId(ItemAssetType, FName(*ItemPaths[ItemId].GetAssetName())));
+		}
+	}
+
+	return UAssetManager::Get().LoadPrimaryAssets(AssetIds, Bundles, Delegate);
+}
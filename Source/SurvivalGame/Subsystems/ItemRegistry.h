@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "ItemRegistry.generated.h"
+
+/**
+ * Every item definition in the game, found through the Asset Manager at startup and given a 16 bit id.
+ * Replication sends that id instead of an object path/NetGUID, and it's what save data should store.
+ *
+ * Definitions only hold soft references to their presentation, grouped into asset bundles:
+ * loading a definition with no bundles (what servers do) brings in just its gameplay data,
+ * "UI" adds the thumbnail and tooltip and "World" the pickup mesh.
+ *
+ * An engine subsystem rather than a game instance one, net serialization has no world to find it through.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UItemRegistry : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UItemRegistry();
+
+	//Primary asset type every item definition is registered under
+	static const FPrimaryAssetType ItemAssetType;
+
+	//Asset bundles, see UItemDefinition
+	static const FName UIBundle;
+	static const FName WorldBundle;
+
+	static UItemRegistry* Get();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	//0 if Definition isn't registered (or is null)
+	static uint16 GetItemId(const class UItemDefinition* Definition);
+
+	//Null for 0 or unknown ids. Definitions are small, one that isn't loaded yet is loaded on the spot
+	static class UItemDefinition* FindDefinition(uint16 ItemId);
+
+	//Writes/reads a definition as its id, for NetSerialize functions
+	//unregistered definitions fall back to a normal object reference so nothing breaks while the registry is misconfigured
+	static void NetSerializeDefinition(FArchive& Ar, class UPackageMap* Map, class UItemDefinition*& Definition);
+
+	//Load a set of definitions along with the given bundles (none = gameplay data only), Delegate runs once they're all in
+	TSharedPtr<FStreamableHandle> LoadItems(const TArray<uint16>& ItemIds, const TArray<FName>& Bundles, FStreamableDelegate Delegate = FStreamableDelegate());
+
+	FORCEINLINE int32 GetNumItems() const { return IdsByName.Num(); }
+
+	//Every id in use. Ids set on definitions can leave gaps, so they aren't simply 1 to GetNumItems()
+	void GetItemIds(TArray<uint16>& OutItemIds) const;
+
+protected:
+
+	//Where to look for item definitions, the Asset Manager scans these for UItemDefinition assets
+	UPROPERTY(Config)
+	TArray<FString> ItemScanPaths;
+
+	//Scan and number every definition. Ids set on the definitions are kept, the rest are numbered
+	//after them in name order, so they only match between machines running the same build
+	void BuildRegistry();
+
+	//indexed by id, 0 is unused
+	TArray<FSoftObjectPath> ItemPaths;
+
+	TMap<FName, uint16> IdsByName;
+
+	//keeps every definition's gameplay data loaded
+	TSharedPtr<FStreamableHandle> PreloadHandle;
+};
+
+//An item definition that replicates as its registry id, for replicated properties that point at a definition
+USTRUCT()
+struct SURVIVALGAME_API FReplicatedItemDefinition
+{
+	GENERATED_BODY()
+
+	FReplicatedItemDefinition()
+	{
+		Definition = nullptr;
+	}
+
+	UPROPERTY()
+	class UItemDefinition* Definition;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		UItemRegistry::NetSerializeDefinition(Ar, Map, Definition);
+		bOutSuccess = true;
+		return true;
+	}
+
+	bool operator==(const FReplicatedItemDefinition& Other) const { return Definition == Other.Definition; }
+};
+
+template<>
+struct TStructOpsTypeTraits<FReplicatedItemDefinition> : public TStructOpsTypeTraitsBase2<FReplicatedItemDefinition>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
@@ -0,0 +1,449 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LoadTestHarness.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/GameStateBase.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "TimerManager.h"
+#include "SurvivalBotController.h"
+#include "SurvivalCharacter.h"
+#include "World/Pickup.h"
+#include "Subsystems/PickupPool.h"
+#include "Subsystems/ItemRegistry.h"
+#include "SurvivalGame.h"
+
+//RPCs are counted from their implementations, which don't know which world they are in, so the counts are global
+static bool bRecordingRPCs = false;
+static TMap<FName, int32> RPCCounts;
+
+ULoadTestHarness::ULoadTestHarness()
+{
+	DefaultNumBots = 32;
+	DefaultDuration = 120.f;
+	DefaultNumPickups = 64;
+	SpawnRadius = 3000.f;
+	RestockInterval = 1.f;
+
+	bRunning = false;
+	StartTime = 0.0;
+	NumPickups = 0;
+	Origin = FVector::ZeroVector;
+	TickStartCycles = 0;
+	PreActorTickCycles = 0;
+	PostActorTickCycles = 0;
+	LastFrameEndTime = 0.0;
+}
+
+ULoadTestHarness* ULoadTestHarness::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		return UGameInstance::GetSubsystem<ULoadTestHarness>(World->GetGameInstance());
+	}
+
+	return nullptr;
+}
+
+void ULoadTestHarness::Deinitialize()
+{
+	UnbindDelegates();
+
+	bRunning = false;
+	bRecordingRPCs = false;
+
+	Super::Deinitialize();
+}
+
+void ULoadTestHarness::StartIfRequested(UWorld* World)
+{
+	const TCHAR* CommandLine = FCommandLine::Get();
+
+	if (bRunning || !World || World->IsNetMode(NM_Client) || !FParse::Param(CommandLine, TEXT("LoadTest")))
+	{
+		return;
+	}
+
+	int32 NumBots = DefaultNumBots;
+	float Duration = DefaultDuration;
+	NumPickups = DefaultNumPickups;
+
+	FParse::Value(CommandLine, TEXT("LoadTestBots="), NumBots);
+	FParse::Value(CommandLine, TEXT("LoadTestDuration="), Duration);
+	FParse::Value(CommandLine, TEXT("LoadTestPickups="), NumPickups);
+
+	if (!FParse::Value(CommandLine, TEXT("LoadTestCsv="), CsvPath))
+	{
+		CsvPath = FPaths::ProjectSavedDir() / TEXT("LoadTest") / FString::Printf(TEXT("LoadTest-%s.csv"), *FDateTime::Now().ToString());
+	}
+
+	AGameModeBase* GameMode = World->GetAuthGameMode();
+	AActor* PlayerStart = GameMode ? GameMode->FindPlayerStart(nullptr) : nullptr;
+	Origin = PlayerStart ? PlayerStart->GetActorLocation() : FVector::ZeroVector;
+
+	UE_LOG(LogSurvivalGame, Display, TEXT("Load test: %d bots, %d pickups, %.0fs, report to %s"), NumBots, NumPickups, Duration, *CsvPath);
+
+	bRunning = true;
+	bRecordingRPCs = true;
+	RPCCounts.Reset();
+	StartTime = FPlatformTime::Seconds();
+	LastFrameEndTime = StartTime;
+	FrameSamples.Reset();
+	FrameSamples.Reserve(FMath::CeilToInt(Duration * 60.f));
+
+	TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &ULoadTestHarness::OnWorldTickStart);
+	PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &ULoadTestHarness::OnWorldPreActorTick);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ULoadTestHarness::OnWorldPostActorTick);
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &ULoadTestHarness::OnEndFrame);
+
+	for (int32 i = 0; i < NumBots; ++i)
+	{
+		SpawnBot(World);
+	}
+
+	RestockPickups();
+
+	FTimerManager& TimerManager = World->GetTimerManager();
+	TimerManager.SetTimer(TimerHandle_Sample, this, &ULoadTestHarness::SampleConnections, 1.f, true);
+	TimerManager.SetTimer(TimerHandle_Restock, this, &ULoadTestHarness::RestockPickups, RestockInterval, true);
+	TimerManager.SetTimer(TimerHandle_Finish, this, &ULoadTestHarness::FinishRun, FMath::Max(Duration, 1.f), false);
+}
+
+APickup* ULoadTestHarness::GetRandomPickup() const
+{
+	if (StockedPickups.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	APickup* Pickup = StockedPickups[FMath::RandRange(0, StockedPickups.Num() - 1)].Get();
+	return Pickup && !Pickup->IsPooled() ? Pickup : nullptr;
+}
+
+void ULoadTestHarness::RecordRPC(const TCHAR* RPCName)
+{
+	if (bRecordingRPCs)
+	{
+		++RPCCounts.FindOrAdd(FName(RPCName));
+	}
+}
+
+bool ULoadTestHarness::FindSpawnLocation(UWorld* World, FVector& OutLocation) const
+{
+	const float Angle = FMath::FRand() * 2.f * PI;
+	const float Distance = SpawnRadius * FMath::Sqrt(FMath::FRand()); //even spread over the disc
+	const FVector Point = Origin + FVector(FMath::Cos(Angle) * Distance, FMath::Sin(Angle) * Distance, 0.f);
+
+	FHitResult Hit;
+	if (!World->LineTraceSingleByChannel(Hit, Point + FVector(0.f, 0.f, 2000.f), Point - FVector(0.f, 0.f, 5000.f), ECC_Visibility))
+	{
+		return false;
+	}
+
+	OutLocation = Hit.ImpactPoint;
+	return true;
+}
+
+void ULoadTestHarness::SpawnBot(UWorld* World)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	ASurvivalBotController* Bot = World->SpawnActor<ASurvivalBotController>(SpawnParams);
+	if (!Bot)
+	{
+		return;
+	}
+
+	//whatever the game mode would give a player, as long as it is one of ours
+	AGameModeBase* GameMode = World->GetAuthGameMode();
+	UClass* PawnClass = GameMode ? GameMode->GetDefaultPawnClassForController(Bot) : nullptr;
+
+	if (!PawnClass || !PawnClass->IsChildOf(ASurvivalCharacter::StaticClass()))
+	{
+		PawnClass = ASurvivalCharacter::StaticClass();
+	}
+
+	FVector Location;
+	if (!FindSpawnLocation(World, Location))
+	{
+		Location = Origin;
+	}
+
+	const FRotator Rotation(0.f, FMath::FRand() * 360.f, 0.f);
+	const float HalfHeight = PawnClass->GetDefaultObject<ASurvivalCharacter>()->GetDefaultHalfHeight();
+
+	ASurvivalCharacter* Character = World->SpawnActor<ASurvivalCharacter>(PawnClass, Location + FVector(0.f, 0.f, HalfHeight), Rotation, SpawnParams);
+	if (!Character)
+	{
+		Bot->Destroy();
+		return;
+	}
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("BotInteractInterval="), Bot->InteractInterval);
+	FParse::Value(CommandLine, TEXT("BotJumpInterval="), Bot->JumpInterval);
+	FParse::Value(CommandLine, TEXT("BotCrouchInterval="), Bot->CrouchInterval);
+	FParse::Value(CommandLine, TEXT("BotMoveChangeInterval="), Bot->MoveChangeInterval);
+
+	Bot->Possess(Character);
+	Bots.Add(Bot);
+}
+
+void ULoadTestHarness::RestockPickups()
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+	UPickupPool* Pool = UPickupPool::Get(World);
+	UItemRegistry* Registry = UItemRegistry::Get();
+
+	//taken pickups go back to the pool, forget them
+	StockedPickups.RemoveAllSwap([](const TWeakObjectPtr<APickup>& Pickup)
+	{
+		return !Pickup.IsValid() || Pickup->IsPooled();
+	});
+
+	TArray<uint16> ItemIds;
+	if (Registry)
+	{
+		Registry->GetItemIds(ItemIds);
+	}
+
+	if (!World || !Pool || ItemIds.Num() == 0)
+	{
+		return;
+	}
+
+	while (StockedPickups.Num() < NumPickups)
+	{
+		UItemDefinition* Definition = UItemRegistry::FindDefinition(ItemIds[FMath::RandHelper(ItemIds.Num())]);
+
+		FVector Location;
+		if (!Definition || !FindSpawnLocation(World, Location))
+		{
+			break; //try again next restock
+		}
+
+		UItem* Item = Pool->AcquireItem(World->GetGameState(), Definition, 1);
+		APickup* Pickup = Pool->AcquirePickup(World, Item, FTransform(Location + FVector(0.f, 0.f, 20.f)));
+
+		if (!Pickup)
+		{
+			Pool->ReleaseItem(Item);
+			break;
+		}
+
+		StockedPickups.Add(Pickup);
+	}
+}
+
+void ULoadTestHarness::OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (World == GetGameInstance()->GetWorld())
+	{
+		TickStartCycles = FPlatformTime::Cycles64();
+		PreActorTickCycles = TickStartCycles;
+		PostActorTickCycles = TickStartCycles;
+	}
+}
+
+void ULoadTestHarness::OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (TickStartCycles != 0 && World == GetGameInstance()->GetWorld())
+	{
+		PreActorTickCycles = FPlatformTime::Cycles64();
+	}
+}
+
+void ULoadTestHarness::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (TickStartCycles != 0 && World == GetGameInstance()->GetWorld())
+	{
+		PostActorTickCycles = FPlatformTime::Cycles64();
+	}
+}
+
+void ULoadTestHarness::OnEndFrame()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	if (TickStartCycles != 0)
+	{
+		const double MsPerCycle = FPlatformTime::GetSecondsPerCycle64() * 1000.0;
+		const uint64 EndCycles = FPlatformTime::Cycles64();
+
+		FLoadTestFrameSample& Sample = FrameSamples.AddDefaulted_GetRef();
+		Sample.FrameMs = (Now - LastFrameEndTime) * 1000.0;
+		Sample.PreActorTickMs = (PreActorTickCycles - TickStartCycles) * MsPerCycle;
+		Sample.ActorTickMs = (PostActorTickCycles - PreActorTickCycles) * MsPerCycle;
+		Sample.PostActorTickMs = (EndCycles - PostActorTickCycles) * MsPerCycle;
+	}
+
+	TickStartCycles = 0;
+	LastFrameEndTime = Now;
+}
+
+void ULoadTestHarness::SampleConnections()
+{
+	UNetDriver* NetDriver = GetGameInstance()->GetWorld() ? GetGameInstance()->GetWorld()->GetNetDriver() : nullptr;
+
+	if (!NetDriver)
+	{
+		return;
+	}
+
+	for (UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (!Connection)
+		{
+			continue;
+		}
+
+		FLoadTestConnectionStats& Stats = ConnectionStats.FindOrAdd(Connection->LowLevelGetRemoteAddress(true));
+		++Stats.NumSamples;
+		Stats.TotalOutBytesPerSecond += Connection->OutBytesPerSecond;
+		Stats.TotalInBytesPerSecond += Connection->InBytesPerSecond;
+		Stats.PeakOutBytesPerSecond = FMath::Max(Stats.PeakOutBytesPerSecond, Connection->OutBytesPerSecond);
+		Stats.TotalOpenChannels += Connection->OpenChannels.Num();
+	}
+}
+
+void ULoadTestHarness::FinishRun()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	UnbindDelegates();
+	bRecordingRPCs = false;
+
+	WriteReport();
+
+	bRunning = false;
+
+	if (!FParse::Param(FCommandLine::Get(), TEXT("LoadTestNoExit")))
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+//Value at the given fraction (0-1) of an already sorted array
+static float Percentile(const TArray<float>& Sorted, float Fraction)
+{
+	if (Sorted.Num() == 0)
+	{
+		return 0.f;
+	}
+
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+	return Sorted[Index];
+}
+
+//Avg, P50, P90, P99 and Max rows for one column of the frame samples
+static void AddTimingRows(FString& Csv, const TCHAR* Category, const TCHAR* Name, TArray<float> Values)
+{
+	Values.Sort();
+
+	double Total = 0.0;
+	for (float Value : Values)
+	{
+		Total += Value;
+	}
+
+	Csv += FString::Printf(TEXT("%s,%s,AvgMs,%.3f\n"), Category, Name, Values.Num() > 0 ? Total / Values.Num() : 0.0);
+	Csv += FString::Printf(TEXT("%s,%s,P50Ms,%.3f\n"), Category, Name, Percentile(Values, 0.5f));
+	Csv += FString::Printf(TEXT("%s,%s,P90Ms,%.3f\n"), Category, Name, Percentile(Values, 0.9f));
+	Csv += FString::Printf(TEXT("%s,%s,P99Ms,%.3f\n"), Category, Name, Percentile(Values, 0.99f));
+	Csv += FString::Printf(TEXT("%s,%s,MaxMs,%.3f\n"), Category, Name, Values.Num() > 0 ? Values.Last() : 0.f);
+}
+
+void ULoadTestHarness::WriteReport() const
+{
+	TArray<float> FrameMs, PreActorTickMs, ActorTickMs, PostActorTickMs, GameThreadMs;
+
+	for (const FLoadTestFrameSample& Sample : FrameSamples)
+	{
+		FrameMs.Add(Sample.FrameMs);
+		PreActorTickMs.Add(Sample.PreActorTickMs);
+		ActorTickMs.Add(Sample.ActorTickMs);
+		PostActorTickMs.Add(Sample.PostActorTickMs);
+		GameThreadMs.Add(Sample.PreActorTickMs + Sample.ActorTickMs + Sample.PostActorTickMs);
+	}
+
+	int32 NumInteractions = 0, NumJumps = 0, NumCrouches = 0, NumBots = 0;
+
+	for (const TWeakObjectPtr<ASurvivalBotController>& Bot : Bots)
+	{
+		if (Bot.IsValid())
+		{
+			++NumBots;
+			NumInteractions += Bot->NumInteractions;
+			NumJumps += Bot->NumJumps;
+			NumCrouches += Bot->NumCrouches;
+		}
+	}
+
+	//long format, one value per row, so runs can be diffed and loaded straight into a spreadsheet
+	FString Csv = TEXT("Category,Name,Stat,Value\n");
+
+	Csv += FString::Printf(TEXT("Run,Bots,Count,%d\n"), NumBots);
+	Csv += FString::Printf(TEXT("Run,Duration,Seconds,%.1f\n"), FPlatformTime::Seconds() - StartTime);
+	Csv += FString::Printf(TEXT("Run,Frames,Count,%d\n"), FrameSamples.Num());
+
+	AddTimingRows(Csv, TEXT("FrameTime"), TEXT("Frame"), FrameMs);
+	AddTimingRows(Csv, TEXT("GameThread"), TEXT("Total"), GameThreadMs);
+	AddTimingRows(Csv, TEXT("GameThread"), TEXT("PreActorTick"), PreActorTickMs);
+	AddTimingRows(Csv, TEXT("GameThread"), TEXT("ActorTick"), ActorTickMs);
+	AddTimingRows(Csv, TEXT("GameThread"), TEXT("PostActorTick"), PostActorTickMs);
+
+	for (const TPair<FString, FLoadTestConnectionStats>& Connection : ConnectionStats)
+	{
+		const FLoadTestConnectionStats& Stats = Connection.Value;
+		const double Samples = FMath::Max(Stats.NumSamples, 1);
+
+		Csv += FString::Printf(TEXT("Connection,%s,AvgOutBytesPerSec,%.0f\n"), *Connection.Key, Stats.TotalOutBytesPerSecond / Samples);
+		Csv += FString::Printf(TEXT("Connection,%s,PeakOutBytesPerSec,%d\n"), *Connection.Key, Stats.PeakOutBytesPerSecond);
+		Csv += FString::Printf(TEXT("Connection,%s,AvgInBytesPerSec,%.0f\n"), *Connection.Key, Stats.TotalInBytesPerSecond / Samples);
+		Csv += FString::Printf(TEXT("Connection,%s,AvgOpenChannels,%.1f\n"), *Connection.Key, Stats.TotalOpenChannels / Samples);
+	}
+
+	for (const TPair<FName, int32>& RPC : RPCCounts)
+	{
+		Csv += FString::Printf(TEXT("RPC,%s,Count,%d\n"), *RPC.Key.ToString(), RPC.Value);
+	}
+
+	Csv += FString::Printf(TEXT("Bots,Interactions,Count,%d\n"), NumInteractions);
+	Csv += FString::Printf(TEXT("Bots,Jumps,Count,%d\n"), NumJumps);
+	Csv += FString::Printf(TEXT("Bots,Crouches,Count,%d\n"), NumCrouches);
+
+	if (FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogSurvivalGame, Display, TEXT("Load test finished, %d frames, report written to %s"), FrameSamples.Num(), *CsvPath);
+	}
+	else
+	{
+		UE_LOG(LogSurvivalGame, Error, TEXT("Load test finished but the report couldn't be written to %s"), *CsvPath);
+	}
+}
+
+void ULoadTestHarness::UnbindDelegates()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+
+	if (UWorld* World = GetGameInstance() ? GetGameInstance()->GetWorld() : nullptr)
+	{
+		World->GetTimerManager().ClearTimer(TimerHandle_Sample);
+		World->GetTimerManager().ClearTimer(TimerHandle_Restock);
+		World->GetTimerManager().ClearTimer(TimerHandle_Finish);
+	}
+}
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "LoadTestHarness.generated.h"
+
+//Where one server frame's game thread time went
+struct FLoadTestFrameSample
+{
+	float FrameMs = 0.f; //wall time since the last frame, includes waiting for the next server tick
+	float PreActorTickMs = 0.f; //net receive and level streaming
+	float ActorTickMs = 0.f; //actors and components
+	float PostActorTickMs = 0.f; //tickable objects (our subsystems), net send and the rest of the frame
+};
+
+//Per client connection, sampled once a second
+struct FLoadTestConnectionStats
+{
+	int32 NumSamples = 0;
+	int64 TotalOutBytesPerSecond = 0;
+	int64 TotalInBytesPerSecond = 0;
+	int32 PeakOutBytesPerSecond = 0;
+	int64 TotalOpenChannels = 0;
+};
+
+/**
+ * Headless load test, reproduces a busy server locally. Start a dedicated server with -LoadTest, e.g.
+ *   SurvivalGameServer <Map> -nullrhi -log -LoadTest -LoadTestBots=64 -LoadTestDuration=300
+ * (or UE4Editor SurvivalGame <Map> -server -nullrhi -LoadTest ...). It spawns bots (ASurvivalBotController) around the first
+ * player start, keeps pickups stocked for them to take, and when the time is up writes a CSV with frame time percentiles,
+ * the game thread breakdown, bytes per connection and RPC counts, then exits.
+ * Bots are server side, connect a few -nullrhi clients to the server to measure replication.
+ *
+ * Options: -LoadTestBots= -LoadTestDuration= (seconds) -LoadTestPickups= -LoadTestCsv= (path) -LoadTestNoExit
+ * Bot rates, average seconds between each: -BotInteractInterval= -BotJumpInterval= -BotCrouchInterval= -BotMoveChangeInterval=
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API ULoadTestHarness : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	ULoadTestHarness();
+
+	//Helper function to grab the harness for the world an object lives in
+	static ULoadTestHarness* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	//[server] Starts a run if the command line asks for one, called once the game mode has begun play
+	void StartIfRequested(UWorld* World);
+
+	FORCEINLINE bool IsRunning() const { return bRunning; }
+
+	//One of the pickups we stocked that is still waiting to be taken, for bots to walk to
+	class APickup* GetRandomPickup() const;
+
+	//Counts an RPC for the report, does nothing unless a run is going
+	static void RecordRPC(const TCHAR* RPCName);
+
+protected:
+
+	//Defaults for the command line options
+	UPROPERTY(Config)
+	int32 DefaultNumBots;
+
+	UPROPERTY(Config)
+	float DefaultDuration;
+
+	UPROPERTY(Config)
+	int32 DefaultNumPickups;
+
+	//Bots and pickups are placed within this many cm of the player start
+	UPROPERTY(Config)
+	float SpawnRadius;
+
+	//How often taken pickups are replaced
+	UPROPERTY(Config)
+	float RestockInterval;
+
+	bool bRunning;
+	double StartTime;
+	int32 NumPickups;
+	FString CsvPath;
+
+	FVector Origin;
+
+	TArray<TWeakObjectPtr<class ASurvivalBotController>> Bots;
+	TArray<TWeakObjectPtr<class APickup>> StockedPickups;
+
+	TArray<FLoadTestFrameSample> FrameSamples;
+	TMap<FString, FLoadTestConnectionStats> ConnectionStats;
+
+	//World tick markers for the frame being measured, 0 when not inside a world tick
+	uint64 TickStartCycles;
+	uint64 PreActorTickCycles;
+	uint64 PostActorTickCycles;
+	double LastFrameEndTime;
+
+	FDelegateHandle TickStartHandle;
+	FDelegateHandle PreActorTickHandle;
+	FDelegateHandle PostActorTickHandle;
+	FDelegateHandle EndFrameHandle;
+
+	FTimerHandle TimerHandle_Sample;
+	FTimerHandle TimerHandle_Restock;
+	FTimerHandle TimerHandle_Finish;
+
+	void SpawnBot(UWorld* World);
+	void RestockPickups();
+
+	//Random point on the ground near Origin
+	bool FindSpawnLocation(UWorld* World, FVector& OutLocation) const;
+
+	void OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime);
+	void OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaTime);
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime);
+	void OnEndFrame();
+
+	//Once a second, bytes and channels per client connection
+	void SampleConnections();
+
+	void FinishRun();
+	void WriteReport() const;
+
+	void UnbindDelegates();
+};
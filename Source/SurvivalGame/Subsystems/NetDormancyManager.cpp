@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NetDormancyManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dormant Actors"), STAT_DormantActors, STATGROUP_SurvivalGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Awake Actors"), STAT_AwakeActors, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dormancy Wakes"), STAT_DormancyWakes, STATGROUP_SurvivalGame);
+
+UNetDormancyManager::UNetDormancyManager()
+{
+	QuietPeriod = 2.f;
+}
+
+UNetDormancyManager* UNetDormancyManager::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		return UGameInstance::GetSubsystem<UNetDormancyManager>(World->GetGameInstance());
+	}
+
+	return nullptr;
+}
+
+void UNetDormancyManager::Wake(AActor* Actor)
+{
+	if (Actor && Actor->HasAuthority())
+	{
+		if (UNetDormancyManager* Manager = Get(Actor))
+		{
+			Manager->WakeActor(Actor);
+		}
+	}
+}
+
+void UNetDormancyManager::Deinitialize()
+{
+	ManagedActors.Empty();
+	AwakeActors.Empty();
+	UpdateStats();
+
+	Super::Deinitialize();
+}
+
+void UNetDormancyManager::RegisterActor(AActor* Actor)
+{
+	if (!Actor || !Actor->HasAuthority() || !Actor->GetIsReplicated() || ManagedActors.Contains(Actor))
+	{
+		return;
+	}
+
+	ManagedActors.Add(Actor);
+
+	//placed actors the client already loaded with the level don't need to send anything until they change
+	if (Actor->IsNetStartupActor() && !Actor->HasActorBegunPlay())
+	{
+		Actor->NetDormancy = DORM_Initial;
+	}
+	else
+	{
+		Actor->SetNetDormancy(DORM_DormantAll);
+	}
+
+	UpdateStats();
+}
+
+void UNetDormancyManager::UnregisterActor(AActor* Actor)
+{
+	ManagedActors.Remove(Actor);
+	AwakeActors.RemoveAllSwap([Actor](const FAwakeActor& Awake) { return Awake.Actor == Actor; });
+
+	UpdateStats();
+}
+
+void UNetDormancyManager::WakeActor(AActor* Actor)
+{
+	if (!ManagedActors.Contains(Actor))
+	{
+		return;
+	}
+
+	const float Now = Actor->GetWorld()->GetTimeSeconds();
+
+	if (FAwakeActor* Awake = AwakeActors.FindByPredicate([Actor](const FAwakeActor& Awake) { return Awake.Actor == Actor; }))
+	{
+		Awake->LastActivityTime = Now; //already awake, just push the quiet period back
+		return;
+	}
+
+	//flushes whatever the actor had pending and keeps it replicating until it has been quiet for a while
+	Actor->FlushNetDormancy();
+	Actor->SetNetDormancy(DORM_Awake);
+
+	AwakeActors.Add({ Actor, Now });
+
+	SURVIVAL_INC_COUNTER(STAT_DormancyWakes);
+	UpdateStats();
+}
+
+void UNetDormancyManager::Tick(float DeltaTime)
+{
+	UWorld* World = GetTickableGameObjectWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	const float Now = World->GetTimeSeconds();
+	bool bChanged = false;
+
+	for (int32 i = AwakeActors.Num() - 1; i >= 0; --i)
+	{
+		AActor* Actor = AwakeActors[i].Actor.Get();
+
+		if (!Actor || Actor->IsPendingKill())
+		{
+			AwakeActors.RemoveAtSwap(i);
+			bChanged = true;
+			continue;
+		}
+
+		if (Now - AwakeActors[i].LastActivityTime >= QuietPeriod)
+		{
+			Actor->SetNetDormancy(DORM_DormantAll);
+			AwakeActors.RemoveAtSwap(i);
+			bChanged = true;
+		}
+	}
+
+	if (bChanged)
+	{
+		UpdateStats();
+	}
+}
+
+void UNetDormancyManager::UpdateStats() const
+{
+	SET_DWORD_STAT(STAT_DormantActors, GetNumDormantActors());
+	SET_DWORD_STAT(STAT_AwakeActors, GetNumAwakeActors());
+}
+
+bool UNetDormancyManager::IsTickable() const
+{
+	return AwakeActors.Num() > 0; //only the awake ones need watching
+}
+
+TStatId UNetDormancyManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNetDormancyManager, STATGROUP_Tickables);
+}
+
+UWorld* UNetDormancyManager::GetTickableGameObjectWorld() const
+{
+	return GetGameInstance() ? GetGameInstance()->GetWorld() : nullptr;
+}
+
+ETickableTickType UNetDormancyManager::GetTickableTickType() const
+{
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional; //CDO should never tick
+}
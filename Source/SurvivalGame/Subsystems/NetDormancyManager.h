@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "NetDormancyManager.generated.h"
+
+//An actor that was woken up and when it last changed
+struct FAwakeActor
+{
+	TWeakObjectPtr<AActor> Actor;
+
+	float LastActivityTime;
+};
+
+/**
+ * Keeps interactable world actors (pickups, lamps, doors...) net dormant so the server doesn't compare their properties
+ * every net update. Anything that changes one of them wakes it through Wake(), and once it has been quiet for
+ * QuietPeriod it goes back to sleep. Server only, on clients every call is a no-op.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UNetDormancyManager : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UNetDormancyManager();
+
+	//Helper function to grab the manager for the world an object lives in
+	static UNetDormancyManager* Get(const UObject* WorldContextObject);
+
+	//Wake Actor (if it's managed) because something about it is about to change, safe to call with anything
+	static void Wake(AActor* Actor);
+
+	virtual void Deinitialize() override;
+
+	//[server] Put an actor to sleep and start managing it. Level placed actors start DORM_Initial, spawned ones DORM_DormantAll
+	void RegisterActor(AActor* Actor);
+	void UnregisterActor(AActor* Actor);
+
+	void WakeActor(AActor* Actor);
+
+	FORCEINLINE int32 GetNumDormantActors() const { return ManagedActors.Num() - AwakeActors.Num(); }
+	FORCEINLINE int32 GetNumAwakeActors() const { return AwakeActors.Num(); }
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+
+protected:
+
+	//Seconds without changes before a woken actor goes back to sleep
+	UPROPERTY(Config)
+	float QuietPeriod;
+
+	void UpdateStats() const;
+
+	TSet<TWeakObjectPtr<AActor>> ManagedActors;
+
+	TArray<FAwakeActor> AwakeActors;
+};
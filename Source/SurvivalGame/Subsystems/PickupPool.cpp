@@ -0,0 +1,205 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PickupPool.h"
+#include "World/Pickup.h"
+#include "Items/Item.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickup Pool Hits"), STAT_PickupPoolHits, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickup Pool Misses"), STAT_PickupPoolMisses, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Item Pool Hits"), STAT_ItemPoolHits, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Item Pool Misses"), STAT_ItemPoolMisses, STATGROUP_SurvivalGame);
+
+UPickupPool::UPickupPool()
+{
+	PickupPoolSize = 64;
+	ItemPoolSize = 256;
+	PickupClass = APickup::StaticClass();
+	ParkedLocation = FVector(0.f, 0.f, -1000000.f);
+}
+
+UPickupPool* UPickupPool::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		return UGameInstance::GetSubsystem<UPickupPool>(World->GetGameInstance());
+	}
+
+	return nullptr;
+}
+
+void UPickupPool::Deinitialize()
+{
+	FreePickups.Empty();
+	FreeItems.Empty();
+
+	Super::Deinitialize();
+}
+
+void UPickupPool::Prewarm(UWorld* World)
+{
+	if (!World || World->IsNetMode(NM_Client))
+	{
+		return;
+	}
+
+	FreePickups.RemoveAllSwap([World](const TWeakObjectPtr<APickup>& Pickup) { return !Pickup.IsValid() || Pickup->GetWorld() != World; });
+
+	while (FreePickups.Num() < PickupPoolSize)
+	{
+		APickup* Pickup = SpawnPooledPickup(World, FTransform(ParkedLocation));
+		if (!Pickup)
+		{
+			break;
+		}
+
+		Pickup->ResetPickup();
+		FreePickups.Add(Pickup);
+	}
+
+	while (FreeItems.Num() < ItemPoolSize)
+	{
+		FreeItems.Add(NewObject<UItem>(this));
+	}
+}
+
+TSubclassOf<APickup> UPickupPool::GetPickupClass() const
+{
+	return PickupClass ? PickupClass : TSubclassOf<APickup>(APickup::StaticClass());
+}
+
+APickup* UPickupPool::SpawnPooledPickup(UWorld* World, const FTransform& Transform)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	return World->SpawnActor<APickup>(GetPickupClass(), Transform, SpawnParams);
+}
+
+APickup* UPickupPool::AcquirePickup(UWorld* World, UItem* Item, const FTransform& Transform)
+{
+	if (!World || !Item || World->IsNetMode(NM_Client))
+	{
+		return nullptr;
+	}
+
+	APickup* Pickup = nullptr;
+
+	while (!Pickup && FreePickups.Num() > 0)
+	{
+		APickup* Candidate = FreePickups.Pop(false).Get();
+		if (Candidate && !Candidate->IsPendingKill() && Candidate->GetWorld() == World)
+		{
+			Pickup = Candidate;
+		}
+	}
+
+	if (Pickup)
+	{
+		SURVIVAL_INC_COUNTER(STAT_PickupPoolHits);
+		++Stats.PickupHits;
+
+		Pickup->SetActorTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+	else
+	{
+		SURVIVAL_INC_COUNTER(STAT_PickupPoolMisses);
+		++Stats.PickupMisses;
+
+		Pickup = SpawnPooledPickup(World, Transform);
+	}
+
+	if (Pickup)
+	{
+		Pickup->InitializePickup(Item);
+	}
+
+	return Pickup;
+}
+
+void UPickupPool::ReleasePickup(APickup* Pickup)
+{
+	if (!Pickup || Pickup->IsPooled() || !Pickup->HasAuthority())
+	{
+		return;
+	}
+
+	if (UItem* OldItem = Pickup->ResetPickup())
+	{
+		ReleaseItem(OldItem);
+	}
+
+	if (FreePickups.Num() < PickupPoolSize)
+	{
+		Pickup->SetActorLocation(ParkedLocation);
+		FreePickups.Add(Pickup);
+	}
+	else //pool is full, don't let a big loot explosion keep hundreds of hidden actors around forever
+	{
+		Pickup->Destroy();
+	}
+}
+
+UItem* UPickupPool::AcquireItem(UObject* Outer, UItemDefinition* Definition, int32 Quantity)
+{
+	UItem* Item = nullptr;
+
+	if (FreeItems.Num() > 0)
+	{
+		SURVIVAL_INC_COUNTER(STAT_ItemPoolHits);
+		++Stats.ItemHits;
+
+		Item = FreeItems.Pop(false);
+		Item->Rename(nullptr, Outer, REN_DontCreateRedirectors | REN_ForceNoResetLoaders);
+	}
+	else
+	{
+		SURVIVAL_INC_COUNTER(STAT_ItemPoolMisses);
+		++Stats.ItemMisses;
+
+		Item = NewObject<UItem>(Outer);
+	}
+
+	Item->Definition = Definition;
+	Item->Quantity = Quantity;
+
+	return Item;
+}
+
+void UPickupPool::ReleaseItem(UItem* Item)
+{
+	if (!Item || Item->OwningInventory || Item->GetClass() != UItem::StaticClass()) //blueprint item subclasses aren't interchangeable, let them go
+	{
+		return;
+	}
+
+	//clients may still hold it under its old actor, handing it to another one would reuse the same NetGUID there. Only server side items get recycled
+	if (Item->HasReplicated())
+	{
+		return;
+	}
+
+	if (FreeItems.Num() < ItemPoolSize)
+	{
+		Item->ResetItem();
+		Item->Rename(nullptr, this, REN_DontCreateRedirectors | REN_ForceNoResetLoaders); //don't keep the old owner's outer chain alive
+		FreeItems.Add(Item);
+	}
+}
+
+FPickupPoolStats UPickupPool::GetPickupPoolStats(const UObject* WorldContextObject)
+{
+	UPickupPool* Pool = Get(WorldContextObject);
+	if (!Pool)
+	{
+		return FPickupPoolStats();
+	}
+
+	FPickupPoolStats OutStats = Pool->Stats;
+	OutStats.PickupsFree = Pool->FreePickups.Num();
+	OutStats.ItemsFree = Pool->FreeItems.Num();
+	return OutStats;
+}
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "PickupPool.generated.h"
+
+//How well the pools are doing, hits are requests served from the pool, misses had to spawn/construct
+USTRUCT(BlueprintType)
+struct FPickupPoolStats
+{
+	GENERATED_BODY()
+
+	FPickupPoolStats()
+	{
+		PickupHits = PickupMisses = PickupsFree = 0;
+		ItemHits = ItemMisses = ItemsFree = 0;
+	}
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 PickupHits;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 PickupMisses;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 PickupsFree;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 ItemHits;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 ItemMisses;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 ItemsFree;
+};
+
+/**
+ * Recycles world pickups and the UItem objects behind inventory stacks.
+ * Dropping, looting and picking things up churns through both constantly, spawning an actor (and its components)
+ * or constructing an item every time causes hitches and GC pressure, so released ones are parked here and handed out again.
+ * Server only, clients just see the pickups come and go through replication.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API UPickupPool : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UPickupPool();
+
+	//Helper function to grab the pool for the world an object lives in
+	static UPickupPool* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+
+	//[server] Fill the pools up to the configured prewarm counts so the first drops of a match don't spawn anything
+	void Prewarm(UWorld* World);
+
+	//[server] A pickup holding Item placed at Transform. The pickup takes ownership of the item
+	class APickup* AcquirePickup(UWorld* World, class UItem* Item, const FTransform& Transform);
+
+	//[server] Hides the pickup and parks it until it's needed again. Its item goes back to the item pool
+	void ReleasePickup(class APickup* Pickup);
+
+	//[server] A fresh item, Outer should be the actor whose channel replicates it
+	class UItem* AcquireItem(UObject* Outer, class UItemDefinition* Definition, int32 Quantity);
+
+	//[server] Item must not be in an inventory or pickup anymore
+	//Items that have already replicated to a client are left for the GC instead, only ones that never left the server are reused
+	void ReleaseItem(class UItem* Item);
+
+	//The pickup class the pool spawns, anything sizing itself off pickups should read its defaults from here
+	TSubclassOf<class APickup> GetPickupClass() const;
+
+	UFUNCTION(BlueprintPure, Category = "Pool", meta = (WorldContext = "WorldContextObject"))
+	static FPickupPoolStats GetPickupPoolStats(const UObject* WorldContextObject);
+
+protected:
+
+	//pickups spawned by Prewarm, and the most that are kept parked once released
+	UPROPERTY(Config)
+	int32 PickupPoolSize;
+
+	//items constructed by Prewarm, and the most that are kept parked once released
+	UPROPERTY(Config)
+	int32 ItemPoolSize;
+
+	//blueprint subclass to spawn, set in DefaultGame.ini
+	UPROPERTY(Config)
+	TSubclassOf<class APickup> PickupClass;
+
+	//where parked pickups wait, far outside every cull distance so the replication graph never sends them
+	UPROPERTY(Config)
+	FVector ParkedLocation;
+
+	class APickup* SpawnPooledPickup(UWorld* World, const FTransform& Transform);
+
+	//parked pickups belong to whichever world spawned them, anything from an old map is dead and skipped
+	TArray<TWeakObjectPtr<class APickup>> FreePickups;
+
+	UPROPERTY()
+	TArray<class UItem*> FreeItems;
+
+	FPickupPoolStats Stats;
+};
@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SurvivalBotController.h"
+#include "SurvivalCharacter.h"
+#include "World/Pickup.h"
+#include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+#include "Items/Item.h"
+#include "Subsystems/LoadTestHarness.h"
+#include "Engine/World.h"
+
+ASurvivalBotController::ASurvivalBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	MoveChangeInterval = 3.f;
+	MaxTurnRate = 90.f;
+	CrouchInterval = 20.f;
+	JumpInterval = 8.f;
+	InteractInterval = 5.f;
+	InteractHoldTime = 0.2f;
+	SeekTimeout = 15.f;
+
+	NumInteractions = 0;
+	NumJumps = 0;
+	NumCrouches = 0;
+
+	State = ESurvivalBotState::Wander;
+	StateTime = 0.f;
+	ForwardAxis = 0.f;
+	RightAxis = 0.f;
+	TurnRate = 0.f;
+	NextMoveChangeTime = 0.f;
+	NextInteractTime = 0.f;
+	bPendingStopJumping = false;
+}
+
+bool ASurvivalBotController::RollEvery(float Interval, float DeltaTime)
+{
+	return Interval > 0.f && FMath::FRand() < DeltaTime / Interval;
+}
+
+void ASurvivalBotController::SetState(ESurvivalBotState NewState)
+{
+	State = NewState;
+	StateTime = 0.f;
+}
+
+void ASurvivalBotController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ASurvivalCharacter* Character = Cast<ASurvivalCharacter>(GetPawn());
+	if (!Character)
+	{
+		return;
+	}
+
+	StateTime += DeltaTime;
+
+	switch (State)
+	{
+	case ESurvivalBotState::Wander:
+		TickWander(Character, DeltaTime);
+		break;
+	case ESurvivalBotState::Seek:
+		TickSeek(Character, DeltaTime);
+		break;
+	case ESurvivalBotState::Interact:
+		TickInteract(Character, DeltaTime);
+		break;
+	}
+
+	TickStance(Character, DeltaTime);
+}
+
+void ASurvivalBotController::TickWander(ASurvivalCharacter* Character, float DeltaTime)
+{
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	if (Now >= NextMoveChangeTime)
+	{
+		ForwardAxis = FMath::FRandRange(-0.5f, 1.f); //mostly going somewhere
+		RightAxis = FMath::FRandRange(-1.f, 1.f);
+		TurnRate = FMath::FRandRange(-MaxTurnRate, MaxTurnRate);
+		NextMoveChangeTime = Now + MoveChangeInterval * FMath::FRandRange(0.5f, 1.5f);
+	}
+
+	Character->MoveForward(ForwardAxis);
+	Character->MoveRight(RightAxis);
+
+	//Turn goes through AddControllerYawInput, which only takes input from player controllers, so turn the control rotation ourselves
+	SetControlRotation(GetControlRotation() + FRotator(0.f, TurnRate * DeltaTime, 0.f));
+
+	if (InteractInterval > 0.f && Now >= NextInteractTime)
+	{
+		NextInteractTime = Now + InteractInterval * FMath::FRandRange(0.5f, 1.5f);
+
+		ULoadTestHarness* Harness = ULoadTestHarness::Get(this);
+		SeekTarget = Harness ? Harness->GetRandomPickup() : nullptr;
+
+		if (SeekTarget.IsValid())
+		{
+			SetState(ESurvivalBotState::Seek);
+		}
+	}
+}
+
+void ASurvivalBotController::TickSeek(ASurvivalCharacter* Character, float DeltaTime)
+{
+	APickup* Target = SeekTarget.Get();
+
+	//someone else took it, or we can't get there
+	if (!Target || Target->IsPooled() || StateTime > SeekTimeout)
+	{
+		SetState(ESurvivalBotState::Wander);
+		return;
+	}
+
+	FVector EyesLoc;
+	FRotator EyesRot;
+	GetPlayerViewPoint(EyesLoc, EyesRot);
+
+	SetControlRotation((Target->GetActorLocation() - EyesLoc).Rotation());
+	Character->MoveForward(1.f);
+
+	//the interaction check subsystem focuses things for us, same as for a player
+	if (Character->GetInteractable())
+	{
+		Character->BeginInteract();
+		++NumInteractions;
+		SetState(ESurvivalBotState::Interact);
+	}
+}
+
+void ASurvivalBotController::TickInteract(ASurvivalCharacter* Character, float DeltaTime)
+{
+	UInteractionComponent* Interactable = Character->GetInteractable();
+	const float HoldTime = Interactable ? FMath::Max(InteractHoldTime, Interactable->InteractionTime + 0.1f) : 0.f;
+
+	if (StateTime < HoldTime)
+	{
+		return;
+	}
+
+	Character->EndInteract();
+	EmptyInventoryIfFull(Character);
+	SetState(ESurvivalBotState::Wander);
+}
+
+void ASurvivalBotController::TickStance(ASurvivalCharacter* Character, float DeltaTime)
+{
+	if (bPendingStopJumping)
+	{
+		Character->StopJumping();
+		bPendingStopJumping = false;
+	}
+
+	if (RollEvery(JumpInterval, DeltaTime))
+	{
+		Character->Jump();
+		bPendingStopJumping = true;
+		++NumJumps;
+	}
+
+	if (RollEvery(CrouchInterval, DeltaTime))
+	{
+		if (Character->bIsCrouched)
+		{
+			Character->StopCrouching();
+		}
+		else
+		{
+			Character->StartCrouching();
+			++NumCrouches;
+		}
+	}
+}
+
+void ASurvivalBotController::EmptyInventoryIfFull(ASurvivalCharacter* Character)
+{
+	UInventoryComponent* Inventory = Character->PlayerInventory;
+
+	if (!Inventory || (Inventory->GetRemainingCapacity() > 0 && Inventory->GetRemainingWeightCapacity() > 5.f))
+	{
+		return;
+	}
+
+	FInventoryTransaction Drop;
+
+	for (UItem* Item : Inventory->GetItems())
+	{
+		if (Item && Item->Definition)
+		{
+			Drop.ItemsToRemove.Emplace(Item->Definition, Item->Quantity);
+		}
+	}
+
+	Inventory->ApplyTransaction(Drop);
+}
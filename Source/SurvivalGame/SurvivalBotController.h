@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "SurvivalBotController.generated.h"
+
+//What a load test bot is doing right now
+enum class ESurvivalBotState : uint8
+{
+	Wander, //random movement, crouching and jumping
+	Seek, //walking up to a pickup until it is focused
+	Interact //holding interact on whatever is focused
+};
+
+/**
+ * Load test bot, spawned by ULoadTestHarness. Drives a survival character through the same functions player input goes through
+ * (MoveForward/MoveRight, crouch, jump, BeginInteract/EndInteract), so the server does the work a real player would cost it.
+ * The rates are Config and can be overridden on the command line, see ULoadTestHarness.
+ */
+UCLASS(Config = Game)
+class SURVIVALGAME_API ASurvivalBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+
+	ASurvivalBotController();
+
+	//Average seconds between picking a new move direction and turn rate
+	UPROPERTY(Config)
+	float MoveChangeInterval;
+
+	//Fastest the bot turns, degrees per second
+	UPROPERTY(Config)
+	float MaxTurnRate;
+
+	//Average seconds between crouch toggles, 0 = never crouch
+	UPROPERTY(Config)
+	float CrouchInterval;
+
+	//Average seconds between jumps, 0 = never jump
+	UPROPERTY(Config)
+	float JumpInterval;
+
+	//Average seconds between interactions, 0 = never interact
+	UPROPERTY(Config)
+	float InteractInterval;
+
+	//How long interact is held, timed interactions are held until they finish
+	UPROPERTY(Config)
+	float InteractHoldTime;
+
+	//Give up on a pickup we couldn't reach in this many seconds
+	UPROPERTY(Config)
+	float SeekTimeout;
+
+	//Counted for the load test report
+	int32 NumInteractions;
+	int32 NumJumps;
+	int32 NumCrouches;
+
+protected:
+
+	virtual void Tick(float DeltaTime) override;
+
+	ESurvivalBotState State;
+	float StateTime;
+
+	//Current wander input
+	float ForwardAxis;
+	float RightAxis;
+	float TurnRate;
+	float NextMoveChangeTime;
+
+	float NextInteractTime;
+	bool bPendingStopJumping;
+
+	TWeakObjectPtr<class APickup> SeekTarget;
+
+	void SetState(ESurvivalBotState NewState);
+
+	void TickWander(class ASurvivalCharacter* Character, float DeltaTime);
+	void TickSeek(class ASurvivalCharacter* Character, float DeltaTime);
+	void TickInteract(class ASurvivalCharacter* Character, float DeltaTime);
+
+	//Random crouching and jumping, whatever else the bot is doing
+	void TickStance(class ASurvivalCharacter* Character, float DeltaTime);
+
+	//A bot's inventory fills up quickly, empty it through a transaction so the inventory code keeps getting exercised
+	void EmptyInventoryIfFull(class ASurvivalCharacter* Character);
+
+	//true roughly once every Interval seconds
+	static bool RollEvery(float Interval, float DeltaTime);
+};
@@ -5,11 +5,45 @@
 #include "Camera/CameraComponent.h"
 #include "Components/InputComponent.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
 #include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+#include "Subsystems/InteractableRegistry.h"
+#include "Subsystems/InteractionCheckSubsystem.h"
+#include "Subsystems/InteractionScheduler.h"
+#include "Subsystems/GearMeshCache.h"
+#include "Subsystems/CharacterSignificanceManager.h"
+#include "Subsystems/LoadTestHarness.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "DrawDebugHelpers.h"
 #include "GameFramework/Actor.h"
 #include "TimerManager.h"
+#include "SurvivalGame.h"
+
+static TAutoConsoleVariable<int32> CVarAdaptiveInteractionChecks(
+	TEXT("survival.AdaptiveInteractionChecks"),
+	1,
+	TEXT("1 = skip interaction checks while the view isn't moving and nothing nearby changed (default)\n")
+	TEXT("0 = always check at InteractionCheckFrequency"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMergeGearMeshes(
+	TEXT("survival.MergeGearMeshes"),
+	1,
+	TEXT("1 = bake other players' body and gear into one skeletal mesh (default)\n")
+	TEXT("0 = keep a skeletal mesh component per gear slot"),
+	ECVF_Default);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interact Requests Rejected"), STAT_InteractRequestsRejected, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interact Requests Merged"), STAT_InteractRequestsMerged, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Server Interaction Traces"), STAT_ServerInteractionTraces, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Focus Changes"), STAT_FocusChanges, STATGROUP_SurvivalGame);
+
+DECLARE_CYCLE_STAT(TEXT("Perform Interaction Check"), STAT_PerformInteractionCheck, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Find Interaction Candidate"), STAT_FindInteractionCandidate, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Found New Interactable"), STAT_FoundNewInteractable, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Server Begin Interact"), STAT_ServerBeginInteract, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Server Validate Interaction"), STAT_ServerValidateInteraction, STATGROUP_SurvivalGame);
 
 // Sets default values
 ASurvivalCharacter::ASurvivalCharacter()
@@ -17,6 +51,7 @@ ASurvivalCharacter::ASurvivalCharacter()
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	//created in every build so blueprint overrides always find them, dedicated servers just never register them (PreRegisterAllComponents)
 	CameraComponent = CreateDefaultSubobject<UCameraComponent>("CameraComponent");
 	CameraComponent->SetupAttachment(GetMesh(), FName("CameraSocket")); //attach cam to player mesh
 	CameraComponent->bUsePawnControlRotation = true; //camera follows mouse movement
@@ -49,6 +84,14 @@ ASurvivalCharacter::ASurvivalCharacter()
 	BackpackMesh->SetupAttachment(GetMesh()); //attach component to head
 	BackpackMesh->SetMasterPoseComponent(GetMesh()); //lets rest of the body follow the head in animations
 
+	bMergeGearMeshes = true;
+	BaseBodyMesh = nullptr;
+
+	PlayerInventory = CreateDefaultSubobject<UInventoryComponent>("PlayerInventory");
+	PlayerInventory->Capacity = 20;
+	PlayerInventory->WeightCapacity = 80.f;
+	PlayerInventory->bReplicateToOwnerOnly = true;
+
 	//Crouching
 	GetCharacterMovement()->NavAgentProps.bCanCrouch = true;
 
@@ -58,13 +101,143 @@ ASurvivalCharacter::ASurvivalCharacter()
 	//Interaction defaults
 	InteractionCheckFrequency = 0.f; //0 = every frame
 	InteractionCheckDistance = 1000.f; //furthest we check for interactables, 1000 = 10meters
+	InteractionCheckConeAngle = 10.f;
+
+	bAdaptiveInteractionCheck = true;
+	InteractionCheckMoveThreshold = 2.f;
+	InteractionCheckRotationThreshold = 0.25f;
+	InteractionCheckIdleFrequency = 0.5f;
+
+	ServerInteractDistanceTolerance = 50.f;
+	ServerInteractAngleTolerance = 15.f;
+	ServerInteractValidationInterval = 0.25f;
+	ServerOcclusionCheckInterval = 1.f;
+	ServerInteractRequestInterval = 0.1f;
+
+	LastInteractPredictionKey = 0;
 }
 
 // Called when the game starts or when spawned
 void ASurvivalCharacter::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	//let the subsystem batch our interaction checks with everyone else's, we then have no reason to tick
+	if (UInteractionCheckSubsystem* InteractionChecks = UInteractionCheckSubsystem::Get(this))
+	{
+		InteractionChecks->RegisterCharacter(this);
+		SetActorTickEnabled(false);
+	}
+
+	//other players tick and animate only as much as they are worth on screen, the manager ignores our own pawn
+	if (UCharacterSignificanceManager* Significance = UCharacterSignificanceManager::Get(this))
+	{
+		Significance->RegisterCharacter(this);
+	}
+
+	BaseBodyMesh = GetMesh()->SkeletalMesh;
+	RefreshGearMesh();
+}
+
+void ASurvivalCharacter::PreRegisterAllComponents()
+{
+	Super::PreRegisterAllComponents();
+
+	//nothing renders on a dedicated server, left unregistered the cosmetics never create render state, tick or animate there
+	if (UE_SERVER || GetNetMode() == NM_DedicatedServer)
+	{
+		CameraComponent->bAutoRegister = false;
+
+		for (USkeletalMeshComponent* Gear : GetGearMeshes())
+		{
+			Gear->bAutoRegister = false;
+		}
+	}
+}
+
+void ASurvivalCharacter::Restart()
+{
+	Super::Restart();
+
+	if (HasActorBegunPlay())
+	{
+		RefreshGearMesh();
+	}
+}
+
+TArray<USkeletalMeshComponent*> ASurvivalCharacter::GetGearMeshes() const
+{
+	return { HelmetMesh, ChestMesh, LegsMesh, FeetMesh, VestMesh, HandsMesh, BackpackMesh };
+}
+
+bool ASurvivalCharacter::ShouldMergeGearMeshes() const
+{
+	return !UE_SERVER && bMergeGearMeshes && CVarMergeGearMeshes.GetValueOnGameThread() != 0 && GetNetMode() != NM_DedicatedServer && !IsLocallyControlled();
+}
+
+void ASurvivalCharacter::RefreshGearMesh()
+{
+	if (!BaseBodyMesh)
+	{
+		return;
+	}
+
+	USkeletalMesh* MergedMesh = nullptr;
+
+	if (ShouldMergeGearMeshes())
+	{
+		TArray<USkeletalMesh*> Parts;
+		Parts.Add(BaseBodyMesh);
+
+		for (USkeletalMeshComponent* Gear : GetGearMeshes())
+		{
+			if (Gear && Gear->SkeletalMesh)
+			{
+				Parts.Add(Gear->SkeletalMesh);
+			}
+		}
+
+		UGearMeshCache* GearMeshCache = Parts.Num() > 1 ? UGearMeshCache::Get(this) : nullptr;
+		MergedMesh = GearMeshCache ? GearMeshCache->GetMergedMesh(Parts) : nullptr;
+	}
+
+	USkeletalMesh* BodyMesh = MergedMesh ? MergedMesh : BaseBodyMesh;
+	if (GetMesh()->SkeletalMesh != BodyMesh)
+	{
+		GetMesh()->SetSkeletalMesh(BodyMesh, false); //same skeleton, keep the anim instance running
+	}
+
+	const bool bGearMerged = MergedMesh != nullptr;
+
+	//the gear components keep their meshes, that's still what the character is wearing, they just stop rendering and updating
+	for (USkeletalMeshComponent* Gear : GetGearMeshes())
+	{
+		if (Gear)
+		{
+			Gear->SetVisibility(!bGearMerged);
+			Gear->SetComponentTickEnabled(!bGearMerged);
+		}
+	}
+}
+
+void ASurvivalCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UInteractionCheckSubsystem* InteractionChecks = UInteractionCheckSubsystem::Get(this))
+	{
+		InteractionChecks->UnregisterCharacter(this);
+	}
+
+	if (UCharacterSignificanceManager* Significance = UCharacterSignificanceManager::Get(this))
+	{
+		Significance->UnregisterCharacter(this);
+	}
+
+	if (UInteractionScheduler* Scheduler = UInteractionScheduler::Get(this))
+	{
+		Scheduler->EndSession(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -73,61 +246,125 @@ void ASurvivalCharacter::BeginPlay()
 //Interaciton Basics
 void ASurvivalCharacter::PerformInteractionCheck()
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_PerformInteractionCheck);
+
+	FVector EyesLoc;
+	UInteractionComponent* Candidate = FindInteractionCandidate(EyesLoc);
+
+	//only trace when there is something worth tracing to
+	ResolveInteractionCheck(Candidate && IsInteractableVisible(Candidate, EyesLoc) ? Candidate : nullptr);
+}
+
+EInteractionCheckSchedule ASurvivalCharacter::GetInteractionCheckSchedule() const
+{
+	//Only the machine controlling us looks for interactables, the server validates the target remote players send it instead
+	if (GetController() == nullptr || !IsLocallyControlled())
+	{
+		return EInteractionCheckSchedule::NotDue;
+	}
+
+	const float TimeSinceLastCheck = GetWorld()->TimeSince(InteractionData.LastInteractionCheckTime);
+
+	if (TimeSinceLastCheck <= InteractionCheckFrequency)
+	{
+		return EInteractionCheckSchedule::NotDue;
+	}
+
+	//Adaptive: until the idle heartbeat is due, only check if the view moved or the interactables around us changed
+	if (bAdaptiveInteractionCheck && CVarAdaptiveInteractionChecks.GetValueOnGameThread() != 0 && TimeSinceLastCheck <= InteractionCheckIdleFrequency)
+	{
+		FVector EyesLoc;
+		FRotator EyesRot;
+
+		GetController()->GetPlayerViewPoint(EyesLoc, EyesRot);
+
+		const bool bMoved = !EyesLoc.Equals(InteractionData.LastCheckEyesLoc, InteractionCheckMoveThreshold);
+		const bool bTurned = !EyesRot.Equals(InteractionData.LastCheckEyesRot, InteractionCheckRotationThreshold);
+
+		if (!bMoved && !bTurned)
+		{
+			const UInteractableRegistry* Registry = UInteractableRegistry::Get(this);
+			const uint32 Revision = Registry ? Registry->GetRevisionNear(EyesLoc, InteractionCheckDistance) : 0;
+
+			if (Revision == InteractionData.LastCheckRegistryRevision)
+			{
+				return EInteractionCheckSchedule::Skipped;
+			}
+		}
+	}
+
+	return EInteractionCheckSchedule::Due;
+}
+
+UInteractionComponent* ASurvivalCharacter::FindInteractionCandidate(FVector& OutEyesLoc)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_FindInteractionCandidate);
+
 	if (GetController() == nullptr) //safety check, if returns null will crash without this 
 	{
-		return;
+		return nullptr;
 	}
 
 	InteractionData.LastInteractionCheckTime = GetWorld()->GetTimeSeconds();
 
-	FVector EyesLoc;
 	FRotator EyesRot;
 
-	GetController()->GetPlayerViewPoint(EyesLoc, EyesRot); //get location of player camera
+	GetController()->GetPlayerViewPoint(OutEyesLoc, EyesRot); //get location of player camera
 
-	FVector TraceStart = EyesLoc;
-	FVector TraceEnd = (EyesRot.Vector() *InteractionCheckDistance) + TraceStart;
-	FHitResult TraceHit;
+	UInteractableRegistry* Registry = UInteractableRegistry::Get(this);
 
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this); //ignores the player when raycasting result
+	//remember what this check saw so adaptive scheduling can tell if the next one is worth doing
+	InteractionData.LastCheckEyesLoc = OutEyesLoc;
+	InteractionData.LastCheckEyesRot = EyesRot;
+	InteractionData.LastCheckRegistryRevision = Registry ? Registry->GetRevisionNear(OutEyesLoc, InteractionCheckDistance) : 0;
 
-	if (GetWorld()->LineTraceSingleByChannel(TraceHit, TraceStart, TraceEnd, ECC_Visibility, QueryParams)) //line cast
-	{
-		//DrawDebugLine(GetWorld(), TraceStart, TraceEnd, FColor::Red, false, .5f); //Debug
+	//ask the registry what is in front of us instead of tracing the whole world, it already checks each object's InteractionDistance
+	return Registry ? Registry->FindBestInteractable(OutEyesLoc, EyesRot.Vector(), InteractionCheckDistance, InteractionCheckConeAngle, this) : nullptr;
+}
 
-		if (TraceHit.GetActor()) //check if hit result is an interactable object
+void ASurvivalCharacter::ResolveInteractionCheck(UInteractionComponent* Interactable)
+{
+	if (Interactable)
+	{
+		if (Interactable != GetInteractable())
 		{
-			if (UInteractionComponent* InteractionComponent = Cast<UInteractionComponent>(TraceHit.GetActor()->GetComponentByClass(UInteractionComponent::StaticClass()))) //check if hitresult has interaction component
-			{
-				float Distance = (TraceStart - TraceHit.ImpactPoint).Size(); // get distance to obj. // size bc vectors?
-
-				if (InteractionComponent != GetInteractable() && Distance <= InteractionComponent->InteractionDistance) //can interact
-				{
-					FoundNewInteractable(InteractionComponent);
-				}
-				else if (Distance > InteractionComponent->InteractionDistance && GetInteractable()) //cannot interact
-				{
-					CouldntFindInteractable();
-				}
-				
-				return;
-			}
+			FoundNewInteractable(Interactable);
 		}
+
+		return;
 	}
 
 	CouldntFindInteractable(); //default
 }
 
+bool ASurvivalCharacter::IsInteractableVisible(UInteractionComponent* Interactable, const FVector& EyesLoc) const
+{
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(InteractionVisibility), false, this); //ignores the player when raycasting result
+	FHitResult TraceHit;
+
+	UInteractionCheckSubsystem::RecordInteractionTrace();
+
+	if (GetWorld()->LineTraceSingleByChannel(TraceHit, EyesLoc, Interactable->GetComponentLocation(), ECC_Visibility, QueryParams))
+	{
+		//DrawDebugLine(GetWorld(), EyesLoc, TraceHit.ImpactPoint, FColor::Red, false, .5f); //Debug
+
+		return TraceHit.GetActor() == Interactable->GetOwner(); //hit the object itself, nothing in the way
+	}
+
+	return true; //nothing blocking the line at all
+}
+
 void ASurvivalCharacter::CouldntFindInteractable()
 {
-	if (GetWorldTimerManager().IsTimerActive(TimerHandle_Interact)) //Lost focus on interactable, clear timer
+	if (UInteractionScheduler* Scheduler = UInteractionScheduler::Get(this)) //Lost focus on interactable, stop the interaction
 	{
-		GetWorldTimerManager().ClearTimer(TimerHandle_Interact);
+		Scheduler->EndSession(this);
 	}
 
 	if (UInteractionComponent* Interactable = GetInteractable()) //Tell interactable we have stopped focus and clear current interactable
 	{
+		SURVIVAL_INC_COUNTER(STAT_FocusChanges);
+
 		Interactable->EndFocus(this);
 
 		if (InteractionData.bInteractHeld) 
@@ -141,7 +378,11 @@ void ASurvivalCharacter::CouldntFindInteractable()
 
 void ASurvivalCharacter::FoundNewInteractable(UInteractionComponent * Interactable)
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_FoundNewInteractable);
+
 	//UE_LOG(LogTemp, Warning, TEXT("FOUND INTERACTABLE")); //debugging
+	SURVIVAL_INC_COUNTER(STAT_FocusChanges);
+
 	EndInteract(); //end existing interactions
 
 	if (UInteractionComponent* OldInteractable = GetInteractable()) //unfocus old interactable
@@ -162,7 +403,18 @@ void ASurvivalCharacter::BeginInteract()
 {
 	if (!HasAuthority()) //if calling body is NOT the server aka is the client, call the server interact
 	{
-		ServerBeginInteract();
+		//instant interactions happen here straight away instead of waiting a round trip, the server tells us if they stood
+		UInteractionComponent* Target = GetInteractable();
+		int32 PredictionKey = 0;
+
+		if (Target && FMath::IsNearlyZero(Target->InteractionTime))
+		{
+			PredictionKey = ++LastInteractPredictionKey;
+			PendingInteractPredictions.Add(PredictionKey, Target);
+		}
+
+		InteractionData.CurrentPredictionKey = PredictionKey;
+		ServerBeginInteract(Target, PredictionKey);
 	}
 
 	InteractionData.bInteractHeld = true;
@@ -171,27 +423,225 @@ void ASurvivalCharacter::BeginInteract()
 	{
 		Interactable->BeginInteract(this);
 
+		UInteractionScheduler* Scheduler = UInteractionScheduler::Get(this);
+
 		if (FMath::IsNearlyZero(Interactable->InteractionTime))
 		{
 			Interact();
 		}
+		else if (!Scheduler) //nothing to time it with, refuse it rather than finish it early
+		{
+			if (HasAuthority())
+			{
+				RejectBeginInteract(Interactable, 0);
+			}
+
+			EndInteract();
+		}
 		else
 		{
-			GetWorldTimerManager().SetTimer(TimerHandle_Interact, this, &ASurvivalCharacter::Interact, Interactable->InteractionTime, false); //start timer
+			Scheduler->BeginSession(this, Interactable, Interactable->InteractionTime); //calls Interact once the time is up
+
+			if (HasAuthority() && !IsLocallyControlled()) //keep an eye on remote players while the timer runs
+			{
+				GetWorldTimerManager().SetTimer(TimerHandle_ValidateInteract, this, &ASurvivalCharacter::ServerValidateInteraction, ServerInteractValidationInterval, true);
+			}
 		}
 	}
+
+	InteractionData.CurrentPredictionKey = 0;
 }
 
-void ASurvivalCharacter::ServerBeginInteract_Implementation()
+void ASurvivalCharacter::ServerBeginInteract_Implementation(UInteractionComponent* Target, int32 PredictionKey)
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_ServerBeginInteract);
+
+	ULoadTestHarness::RecordRPC(TEXT("ServerBeginInteract"));
+
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	//key repeat or a burst of resends for what we are already doing, fold it into the running interaction
+	if (InteractionData.bInteractHeld && Target == GetInteractable())
+	{
+		SURVIVAL_INC_COUNTER(STAT_InteractRequestsMerged);
+		RejectInteractPrediction(PredictionKey); //the running interaction already answers for this press
+		return;
+	}
+
+	if (InteractionData.LastServerInteractRequestTime >= 0.f && Now - InteractionData.LastServerInteractRequestTime < ServerInteractRequestInterval)
+	{
+		SURVIVAL_INC_COUNTER(STAT_InteractRequestsRejected);
+		RejectBeginInteract(Target, PredictionKey);
+		return;
+	}
+
+	InteractionData.LastServerInteractRequestTime = Now;
+
+	const bool bCheckOcclusion = InteractionData.LastServerOcclusionCheckTime < 0.f || Now - InteractionData.LastServerOcclusionCheckTime >= ServerOcclusionCheckInterval;
+	if (bCheckOcclusion)
+	{
+		InteractionData.LastServerOcclusionCheckTime = Now;
+	}
+
+	if (!IsValidInteractionTarget(Target, bCheckOcclusion))
+	{
+		SURVIVAL_INC_COUNTER(STAT_InteractRequestsRejected);
+		RejectBeginInteract(Target, PredictionKey);
+		CouldntFindInteractable();
+		return;
+	}
+
+	if (Target != GetInteractable())
+	{
+		FoundNewInteractable(Target);
+	}
+
+	InteractionData.bLastInteractSucceeded = false;
 	BeginInteract();
+
+	if (PredictionKey != 0) //instant, so it has already happened (or not) by now
+	{
+		ULoadTestHarness::RecordRPC(TEXT("ClientInteractPredictionResult"));
+		ClientInteractPredictionResult(PredictionKey, InteractionData.bLastInteractSucceeded);
+	}
+}
+
+bool ASurvivalCharacter::ServerBeginInteract_Validate(UInteractionComponent* Target, int32 PredictionKey)
+{
+	return true; //a bad target is just ignored, could be lag rather than cheating so don't kick for it
+}
+
+void ASurvivalCharacter::RejectInteractPrediction(int32 PredictionKey)
+{
+	if (PredictionKey != 0)
+	{
+		ULoadTestHarness::RecordRPC(TEXT("ClientInteractPredictionResult"));
+		ClientInteractPredictionResult(PredictionKey, false);
+	}
+}
+
+void ASurvivalCharacter::RejectBeginInteract(UInteractionComponent* Target, int32 PredictionKey)
+{
+	if (PredictionKey != 0)
+	{
+		RejectInteractPrediction(PredictionKey);
+	}
+	else if (Target && !IsLocallyControlled()) //a timed interaction the client is already running a timer for
+	{
+		ULoadTestHarness::RecordRPC(TEXT("ClientEndInteract"));
+		ClientEndInteract(Target);
+	}
+}
+
+void ASurvivalCharacter::ClientEndInteract_Implementation(UInteractionComponent* Target)
+{
+	//already let go, or onto something else the server may well have accepted
+	if (!InteractionData.bInteractHeld || GetInteractable() != Target)
+	{
+		return;
+	}
+
+	StopInteracting();
+}
+
+void ASurvivalCharacter::ClientInteractPredictionResult_Implementation(int32 PredictionKey, bool bAccepted)
+{
+	TWeakObjectPtr<UInteractionComponent> Predicted;
+	if (!PendingInteractPredictions.RemoveAndCopyValue(PredictionKey, Predicted))
+	{
+		return;
+	}
+
+	if (bAccepted)
+	{
+		if (PlayerInventory)
+		{
+			PlayerInventory->ConfirmPrediction(PredictionKey);
+		}
+
+		return;
+	}
+
+	//undo what we showed: predicted items leave the inventory, the interactable puts itself back the way the server has it
+	if (PlayerInventory)
+	{
+		PlayerInventory->RejectPrediction(PredictionKey);
+	}
+
+	if (UInteractionComponent* Interactable = Predicted.Get())
+	{
+		Interactable->RollbackInteract(this, PredictionKey);
+	}
 }
 
-bool ASurvivalCharacter::ServerBeginInteract_Validate()
+bool ASurvivalCharacter::IsValidInteractionTarget(UInteractionComponent* Target, bool bCheckOcclusion) const
 {
+	if (!Target || !Target->IsActive() || !Target->GetOwner() || Target->GetOwner() == this)
+	{
+		return false;
+	}
+
+	FVector EyesLoc;
+	FRotator EyesRot;
+	GetActorEyesViewPoint(EyesLoc, EyesRot);
+
+	//same measurements the registry uses on the client: distance to the interactable's edge, how far it sits off the view ray
+	const float Radius = Target->InteractionRadius;
+
+	const FVector ToTarget = Target->GetComponentLocation() - EyesLoc;
+	const float Distance = FMath::Max(ToTarget.Size() - Radius, 0.f);
+
+	if (Distance > Target->InteractionDistance + ServerInteractDistanceTolerance)
+	{
+		return false;
+	}
+
+	const float Along = FVector::DotProduct(ToTarget, EyesRot.Vector());
+	const float OffAxis = FMath::Sqrt(FMath::Max(ToTarget.SizeSquared() - FMath::Square(Along), 0.f));
+	const float Miss = FMath::Max(OffAxis - Radius, 0.f);
+	const float TanCone = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(InteractionCheckConeAngle + ServerInteractAngleTolerance, 0.f, 89.f)));
+
+	//close enough that the eyes are inside the bounds counts as looking at it, whatever the angle
+	if (Distance > 0.f && (Along <= 0.f || Miss > Along * TanCone))
+	{
+		return false;
+	}
+
+	if (bCheckOcclusion)
+	{
+		SURVIVAL_INC_COUNTER(STAT_ServerInteractionTraces);
+		return IsInteractableVisible(Target, EyesLoc);
+	}
+
 	return true;
 }
 
+void ASurvivalCharacter::ServerValidateInteraction()
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_ServerValidateInteraction);
+
+	if (!IsInteracting())
+	{
+		GetWorldTimerManager().ClearTimer(TimerHandle_ValidateInteract);
+		return;
+	}
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	const bool bCheckOcclusion = Now - InteractionData.LastServerOcclusionCheckTime >= ServerOcclusionCheckInterval;
+
+	if (bCheckOcclusion)
+	{
+		InteractionData.LastServerOcclusionCheckTime = Now;
+	}
+
+	if (!IsValidInteractionTarget(GetInteractable(), bCheckOcclusion)) //walked away or something got in the way, cancel
+	{
+		SURVIVAL_INC_COUNTER(STAT_InteractRequestsRejected);
+		RejectBeginInteract(GetInteractable(), 0);
+		CouldntFindInteractable();
+	}
+}
+
 
 //END INTERACT FUNCTIONS
 void ASurvivalCharacter::EndInteract()
@@ -201,13 +651,34 @@ void ASurvivalCharacter::EndInteract()
 		ServerEndInteract();
 	}
 
+	StopInteracting();
+}
+
+void ASurvivalCharacter::StopInteracting()
+{
+	const bool bWasInteracting = InteractionData.bInteractHeld;
 	InteractionData.bInteractHeld = false;
 
-	GetWorldTimerManager().ClearTimer(TimerHandle_Interact);
+	if (UInteractionScheduler* Scheduler = UInteractionScheduler::Get(this))
+	{
+		Scheduler->EndSession(this);
+	}
+
+	GetWorldTimerManager().ClearTimer(TimerHandle_ValidateInteract);
+
+	if (UInteractionComponent* Interactable = GetInteractable())
+	{
+		if (bWasInteracting) //let go, take us off the interactable's interactor list
+		{
+			Interactable->EndInteract(this);
+		}
+	}
 }
 
 void ASurvivalCharacter::ServerEndInteract_Implementation()
 {
+	ULoadTestHarness::RecordRPC(TEXT("ServerEndInteract"));
+
 	EndInteract();
 }
 
@@ -218,25 +689,42 @@ bool ASurvivalCharacter::ServerEndInteract_Validate()
 
 
 //INTERACT
-void ASurvivalCharacter::Interact()
+bool ASurvivalCharacter::Interact()
 {
-	GetWorldTimerManager().ClearTimer(TimerHandle_Interact); //clear timer
+	if (UInteractionScheduler* Scheduler = UInteractionScheduler::Get(this)) //done, or called early by an instant interaction
+	{
+		Scheduler->EndSession(this);
+	}
+
+	GetWorldTimerManager().ClearTimer(TimerHandle_ValidateInteract);
+
+	InteractionData.bLastInteractSucceeded = false;
 
 	if (UInteractionComponent* Interactable = GetInteractable()) //call interact function on interactable object
 	{
-		Interactable->Interact(this);
+		InteractionData.bLastInteractSucceeded = Interactable->Interact(this);
 	}
+
+	return InteractionData.bLastInteractSucceeded;
 }
 
 
 bool ASurvivalCharacter::IsInteracting() const
 {
-	return GetWorldTimerManager().IsTimerActive(TimerHandle_Interact); 
+	const UInteractionScheduler* Scheduler = UInteractionScheduler::Get(this);
+	return Scheduler && Scheduler->IsInteracting(this);
 }
 
 float ASurvivalCharacter::GetRemainingInteractTime() const
 {
-	return GetWorldTimerManager().GetTimerRemaining(TimerHandle_Interact);
+	const UInteractionScheduler* Scheduler = UInteractionScheduler::Get(this);
+	return Scheduler ? Scheduler->GetRemainingTime(this) : 0.f;
+}
+
+float ASurvivalCharacter::GetInteractProgress() const
+{
+	const UInteractionScheduler* Scheduler = UInteractionScheduler::Get(this);
+	return Scheduler ? Scheduler->GetProgress(this) : 0.f;
 }
 
 
@@ -299,12 +787,16 @@ void ASurvivalCharacter::StopCrouching()
 void ASurvivalCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-	
-	const bool bIsInteractingOnServer = (HasAuthority() && IsInteracting());
 
-	//Server optimization
-	//if (not the server OR is interacting on server) AND time since last interaction is GREATER THAN interaction check freq THEN check for interaction
-	if ((!HasAuthority() || bIsInteractingOnServer) && GetWorld()->TimeSince(InteractionData.LastInteractionCheckTime) > InteractionCheckFrequency) 
+	//only reached when there is no interaction check subsystem, otherwise it runs our checks and our tick is off
+	const EInteractionCheckSchedule Schedule = GetInteractionCheckSchedule();
+
+	if (Schedule != EInteractionCheckSchedule::NotDue)
+	{
+		UInteractionCheckSubsystem::RecordInteractionCheck(Schedule == EInteractionCheckSchedule::Skipped);
+	}
+
+	if (Schedule == EInteractionCheckSchedule::Due)
 	{
 		PerformInteractionCheck();
 	}
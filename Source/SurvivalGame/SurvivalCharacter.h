@@ -6,6 +6,14 @@
 #include "GameFramework/Character.h"
 #include "SurvivalCharacter.generated.h"
 
+//Result of asking a character whether it wants an interaction check this frame
+enum class EInteractionCheckSchedule : uint8
+{
+	NotDue, //InteractionCheckFrequency hasn't passed yet, or this machine doesn't check for this character
+	Skipped, //would have been due but adaptive scheduling saw nothing change since the last check
+	Due
+};
+
 USTRUCT()
 struct FInteractionData //struct is smaller than class, optimization
 {
@@ -16,6 +24,13 @@ struct FInteractionData //struct is smaller than class, optimization
 		ViewedInteractionComponent = nullptr;
 		LastInteractionCheckTime = 0.f;
 		bInteractHeld = false;
+		LastCheckEyesLoc = FVector::ZeroVector;
+		LastCheckEyesRot = FRotator::ZeroRotator;
+		LastCheckRegistryRevision = 0;
+		LastServerInteractRequestTime = -1.f;
+		LastServerOcclusionCheckTime = -1.f;
+		CurrentPredictionKey = 0;
+		bLastInteractSucceeded = false;
 	}
 
 	UPROPERTY()
@@ -27,6 +42,21 @@ struct FInteractionData //struct is smaller than class, optimization
 	UPROPERTY()
 	bool bInteractHeld; //check if the player is holding the interact button
 
+	//where we were looking from/at and what the registry looked like around us during the last check, used by adaptive scheduling
+	FVector LastCheckEyesLoc;
+	FRotator LastCheckEyesRot;
+	uint32 LastCheckRegistryRevision;
+
+	//[server] when this client's last interact request was accepted, and when we last traced to confirm its target
+	float LastServerInteractRequestTime;
+	float LastServerOcclusionCheckTime;
+
+	//prediction key of the interaction being started right now, 0 when it isn't predicted
+	int32 CurrentPredictionKey;
+
+	//what the last Interact() call came back with, the server reports it to a predicting client
+	bool bLastInteractSucceeded;
+
 };
 
 
@@ -35,11 +65,17 @@ class SURVIVALGAME_API ASurvivalCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	friend class UInteractionCheckSubsystem; //batches our interaction checks and hands the results back
+	friend class UInteractionScheduler; //calls Interact when a timed interaction finishes
+	friend class ASurvivalBotController; //load test bots go through the same functions as player input
+	friend struct FSurvivalPerfTestAccess; //automation perf tests time the interaction code directly
+
 public:
 	// Sets default values for this character's properties
 	ASurvivalCharacter();
 
 
+	//COSMETIC COMPONENTS - exist in every build, never registered on dedicated servers
 	UPROPERTY(EditAnywhere, Category = "Components")
 	class UCameraComponent* CameraComponent;
 
@@ -64,9 +100,38 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Components")
 	class USkeletalMeshComponent* BackpackMesh;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Components")
+	class UInventoryComponent* PlayerInventory;
+
+	//GEAR - on other players the body and gear meshes are baked into one mesh on GetMesh() and the gear components are hidden
+	//The local player keeps separate components, it sees its gear but not its body
+	//Can be turned off globally with survival.MergeGearMeshes 0
+	UPROPERTY(EditDefaultsOnly, Category = "Gear")
+	bool bMergeGearMeshes;
+
+	//Call after changing any gear component's mesh, rebuilds (or fetches the cached) merged mesh
+	UFUNCTION(BlueprintCallable, Category = "Gear")
+	void RefreshGearMesh();
+
+	//Whether we should merge right now, changes when the character is possessed
+	bool ShouldMergeGearMeshes() const;
+
+	TArray<class USkeletalMeshComponent*> GetGearMeshes() const;
+
+	//Locally controlled or not can change on possession
+	virtual void Restart() override;
+
+	virtual void PreRegisterAllComponents() override;
+
 protected:
+
+	//GetMesh()'s own mesh before any merging, what the gear is merged onto
+	UPROPERTY()
+	class USkeletalMesh* BaseBodyMesh;
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	// Called every frame
 	virtual void Tick(float DeltaTime) override; //doesn't need to be public, can be protected
 
@@ -74,25 +139,106 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Interaction")
 	float InteractionCheckFrequency;
 
-	//How far to trace when checking if the player is looking at an interactable object
+	//How far to look when checking if the player is looking at an interactable object
 	UPROPERTY(EditDefaultsOnly, Category = "Interaction")
 	float InteractionCheckDistance;
 
+	//Only check while the view is moving or something nearby changed, otherwise drop to InteractionCheckIdleFrequency
+	//Can be turned off globally with survival.AdaptiveInteractionChecks 0
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Adaptive")
+	bool bAdaptiveInteractionCheck;
+
+	//How far in cm the eyes have to move before we check again at full rate
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Adaptive", meta = (EditCondition = bAdaptiveInteractionCheck, ClampMin = 0.0))
+	float InteractionCheckMoveThreshold;
+
+	//How far in degrees the view has to turn before we check again at full rate
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Adaptive", meta = (EditCondition = bAdaptiveInteractionCheck, ClampMin = 0.0))
+	float InteractionCheckRotationThreshold;
+
+	//Heartbeat in seconds while idle, catches anything the movement/registry checks can't see (doors opening etc)
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Adaptive", meta = (EditCondition = bAdaptiveInteractionCheck, ClampMin = 0.0))
+	float InteractionCheckIdleFrequency;
+
+	//Half angle (degrees) of the cone in front of the camera that interactables are picked from
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction", meta = (ClampMin = 0.0, ClampMax = 45.0))
+	float InteractionCheckConeAngle;
+
+	//SERVER VALIDATION - the server doesn't run interaction checks for remote players, it checks the target their client sends instead
+
+	//Extra distance in cm allowed on top of the target's InteractionDistance, covers movement the server hasn't seen yet
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Server", meta = (ClampMin = 0.0))
+	float ServerInteractDistanceTolerance;
+
+	//Extra degrees allowed on top of InteractionCheckConeAngle
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Server", meta = (ClampMin = 0.0))
+	float ServerInteractAngleTolerance;
+
+	//How often in seconds a running timed interaction is re-checked for distance and angle
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Server", meta = (ClampMin = 0.05))
+	float ServerInteractValidationInterval;
+
+	//Occlusion traces are only done this often, the distance/angle checks in between are nearly free
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Server", meta = (ClampMin = 0.0))
+	float ServerOcclusionCheckInterval;
+
+	//Begin interact requests closer together than this are dropped
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction|Server", meta = (ClampMin = 0.0))
+	float ServerInteractRequestInterval;
+
+	//Synchronous check, only used when there is no interaction check subsystem to batch it for us
 	void PerformInteractionCheck();
 
+	//Whether enough time has passed since the last check, and with adaptive scheduling whether anything changed
+	EInteractionCheckSchedule GetInteractionCheckSchedule() const;
+
+	//First half of a check: picks the interactable in front of the camera from the registry, visibility still unconfirmed
+	class UInteractionComponent* FindInteractionCandidate(FVector& OutEyesLoc);
+
+	//Second half of a check: focus the interactable if it passed the visibility test, null if nothing was found
+	void ResolveInteractionCheck(class UInteractionComponent* Interactable);
+
+	//One visibility trace to make sure the candidate the registry picked isn't behind a wall
+	bool IsInteractableVisible(class UInteractionComponent* Interactable, const FVector& EyesLoc) const;
+
 	void CouldntFindInteractable();
 	void FoundNewInteractable(UInteractionComponent* Interactable);
 
 	void BeginInteract();
 	void EndInteract();
 
+	//The local half of EndInteract, without telling the server
+	void StopInteracting();
+
+	//client sends what it is looking at, the server checks it instead of running its own interaction check
+	//PredictionKey is non zero when the client already applied an instant interaction locally and is waiting to hear if it stands
 	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerBeginInteract();
+	void ServerBeginInteract(class UInteractionComponent* Target, int32 PredictionKey);
+
+	//[server -> owning client] Confirms or rolls back a predicted interaction
+	UFUNCTION(Client, Reliable)
+	void ClientInteractPredictionResult(int32 PredictionKey, bool bAccepted);
+
+	//[server] Tell a predicting client its interaction didn't happen
+	void RejectInteractPrediction(int32 PredictionKey);
+
+	//[server -> owning client] The server isn't running our timed interaction with Target, stop the local one instead of finishing it for nothing
+	UFUNCTION(Client, Reliable)
+	void ClientEndInteract(class UInteractionComponent* Target);
+
+	//[server] Tell the client a begin interact it sent didn't happen, however it started it locally
+	void RejectBeginInteract(class UInteractionComponent* Target, int32 PredictionKey);
 
 	UFUNCTION(Server, Reliable, WithValidation)
 	void ServerEndInteract();
 
-	void Interact();
+	bool Interact();
+
+	//[server] Cheap check that a remote player could really be interacting with Target, occlusion is only traced if bCheckOcclusion
+	bool IsValidInteractionTarget(class UInteractionComponent* Target, bool bCheckOcclusion) const;
+
+	//[server] Re-checks a remote player's running timed interaction every ServerInteractValidationInterval
+	void ServerValidateInteraction();
 
 	//Info about current player interactable state
 	UPROPERTY()
@@ -101,8 +247,13 @@ protected:
 	//Helper function to grab interactable faster
 	FORCEINLINE class UInteractionComponent* GetInteractable() const { return InteractionData.ViewedInteractionComponent; }
 
-	//Timer Handler
-	FTimerHandle TimerHandle_Interact;
+	//[client] predicted instant interactions the server hasn't answered yet
+	TMap<int32, TWeakObjectPtr<class UInteractionComponent>> PendingInteractPredictions;
+
+	int32 LastInteractPredictionKey;
+
+	//Timer Handler, timed interactions themselves run on the interaction scheduler
+	FTimerHandle TimerHandle_ValidateInteract;
 public:
 
 	bool IsInteracting() const; //true if interacting with an object that has interaction time
@@ -110,6 +261,11 @@ public:
 
 	float GetRemainingInteractTime() const; //returns time left with current interaction
 
+	float GetInteractProgress() const; //0-1 through the current timed interaction
+
+	//Prediction key of the interaction currently being started, for OnInteract handlers that predict their result. 0 = not predicted
+	FORCEINLINE int32 GetInteractPredictionKey() const { return InteractionData.CurrentPredictionKey; }
+
 
 protected:
 
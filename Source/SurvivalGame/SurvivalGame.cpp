@@ -2,5 +2,33 @@
 
 #include "SurvivalGame.h"
 #include "Modules/ModuleManager.h"
+#include "UObject/CoreRedirects.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, SurvivalGame, "SurvivalGame" );
+DEFINE_LOG_CATEGORY(LogSurvivalGame);
+
+CSV_DEFINE_CATEGORY_MODULE(SURVIVALGAME_API, SurvivalGame, true);
+
+class FSurvivalGameModule : public FDefaultGameModuleImpl
+{
+public:
+
+	virtual void StartupModule() override
+	{
+		//Item Blueprints saved before static item data moved to UItemDefinition still have it under the old names,
+		//load it into UItem's legacy properties so it can be migrated. Registered here since the project has no config to put them in
+		static const TCHAR* LegacyItemProperties[] = { TEXT("Item.PickupMesh"), TEXT("Item.Thumbnail"), TEXT("Item.ItemDisplayName"), TEXT("Item.ItemDescription"),
+			TEXT("Item.UseActionText"), TEXT("Item.Rarity"), TEXT("Item.Weight"), TEXT("Item.bCanStack"), TEXT("Item.MaxStackSize"), TEXT("Item.ItemTooltip"), TEXT("FoodItem.HealAmount") };
+
+		TArray<FCoreRedirect> Redirects;
+
+		for (const TCHAR* Property : LegacyItemProperties)
+		{
+			const FString OldName = FString::Printf(TEXT("/Script/SurvivalGame.%s"), Property);
+			Redirects.Emplace(ECoreRedirectFlags::Type_Property, OldName, OldName + TEXT("_DEPRECATED"));
+		}
+
+		FCoreRedirects::AddRedirectList(Redirects, TEXT("SurvivalGame"));
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FSurvivalGameModule, SurvivalGame, "SurvivalGame" );
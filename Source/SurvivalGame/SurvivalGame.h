@@ -3,4 +3,24 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogSurvivalGame, Log, All);
+
+//everything gameplay side reports here, view in game with 'stat SurvivalGame'
+DECLARE_STATS_GROUP(TEXT("SurvivalGame"), STATGROUP_SurvivalGame, STATCAT_Advanced);
+
+//the same timings and counters go to the CSV profiler under this category ('csvprofile start', or -csvcategories=SurvivalGame)
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SURVIVALGAME_API, SurvivalGame);
+
+//Times the rest of the scope for 'stat SurvivalGame' and the CSV profiler
+//cycle counters are emitted as named events too, so with 'stat namedevents' they show up in external CPU profilers
+#define SURVIVAL_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	CSV_SCOPED_TIMING_STAT(SurvivalGame, Stat)
+
+//Bumps a per frame counter stat, CSV gets the frame's total
+#define SURVIVAL_INC_COUNTER(Stat) \
+	INC_DWORD_STAT(Stat); \
+	CSV_CUSTOM_STAT(SurvivalGame, Stat, 1, ECsvCustomStatOp::Accumulate)
@@ -2,4 +2,39 @@
 
 
 #include "SurvivalGameGameModeBase.h"
+#include "SurvivalGameStateBase.h"
+#include "Subsystems/PickupPool.h"
+#include "Subsystems/LoadTestHarness.h"
+#include "HAL/PlatformMemory.h"
+#include "Engine/World.h"
+#include "SurvivalGame.h"
 
+ASurvivalGameGameModeBase::ASurvivalGameGameModeBase()
+{
+	GameStateClass = ASurvivalGameStateBase::StaticClass(); //carries the loot manager
+}
+
+void ASurvivalGameGameModeBase::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//game mode only exists on the server, which is the only place pickups and items are pooled
+	if (UPickupPool* Pool = UPickupPool::Get(this))
+	{
+		Pool->Prewarm(GetWorld());
+	}
+
+	//startup cost per instance, what the server target saves is measured against this
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+		UE_LOG(LogSurvivalGame, Display, TEXT("Server ready: %.2fs after launch, %.1f MB resident (peak %.1f MB)"),
+			FPlatformTime::Seconds() - GStartTime, MemoryStats.UsedPhysical / (1024.0 * 1024.0), MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0));
+	}
+
+	//-LoadTest on the command line fills the server with bots, see ULoadTestHarness
+	if (ULoadTestHarness* LoadTest = ULoadTestHarness::Get(this))
+	{
+		LoadTest->StartIfRequested(GetWorld());
+	}
+}
@@ -13,5 +13,13 @@ UCLASS()
 class SURVIVALGAME_API ASurvivalGameGameModeBase : public AGameModeBase
 {
 	GENERATED_BODY()
+
+public:
+
+	ASurvivalGameGameModeBase();
+
+protected:
+
+	virtual void BeginPlay() override;
 	
 };
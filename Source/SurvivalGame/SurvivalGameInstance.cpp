@@ -2,4 +2,12 @@
 
 
 #include "SurvivalGameInstance.h"
+#include "SurvivalReplicationGraph.h"
 
+void USurvivalGameInstance::Init()
+{
+	Super::Init();
+
+	//has to be in place before the first net driver is created
+	USurvivalReplicationGraph::RegisterReplicationDriver();
+}
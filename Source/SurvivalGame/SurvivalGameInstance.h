@@ -13,5 +13,9 @@ UCLASS()
 class SURVIVALGAME_API USurvivalGameInstance : public UGameInstance
 {
 	GENERATED_BODY()
+
+public:
+
+	virtual void Init() override;
 	
 };
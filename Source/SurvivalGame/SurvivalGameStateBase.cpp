@@ -2,4 +2,9 @@
 
 
 #include "SurvivalGameStateBase.h"
+#include "Components/LootManagerComponent.h"
 
+ASurvivalGameStateBase::ASurvivalGameStateBase()
+{
+	LootManager = CreateDefaultSubobject<ULootManagerComponent>("LootManager");
+}
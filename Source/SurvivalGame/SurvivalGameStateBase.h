@@ -13,5 +13,13 @@ UCLASS()
 class SURVIVALGAME_API ASurvivalGameStateBase : public AGameStateBase
 {
 	GENERATED_BODY()
+
+public:
+
+	ASurvivalGameStateBase();
+
+	//Server side bookkeeping for idle world loot, the loot itself replicates through ALootCell actors near each player
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Components")
+	class ULootManagerComponent* LootManager;
 	
 };
@@ -2,4 +2,113 @@
 
 
 #include "SurvivalPlayerController.h"
+#include "Components/InteractionComponent.h"
+#include "Widgets/InteractionWidget.h"
+#include "Subsystems/AssetStreamingManager.h"
 
+ASurvivalPlayerController::ASurvivalPlayerController()
+{
+	InteractionCardClass = FSoftClassPath(TEXT("/Game/UserInterface/Widgets/WBP_InteractionCard.WBP_InteractionCard_C"));
+}
+
+void ASurvivalPlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//load it before the player gets near anything so the first focus doesn't wait on it
+	UAssetStreamingManager* Streaming = UAssetStreamingManager::Get(this);
+	if (Streaming && IsLocalController())
+	{
+		Streaming->RequestAsset(InteractionCardClass.ToSoftObjectPath(), EAssetStreamingPriority::High, FSimpleDelegate::CreateUObject(this, &ASurvivalPlayerController::OnInteractionCardClassLoaded));
+	}
+}
+
+void ASurvivalPlayerController::OnInteractionCardClassLoaded()
+{
+	if (PendingInteractionCardTarget.IsValid())
+	{
+		ShowInteractionCard(PendingInteractionCardTarget.Get());
+	}
+
+	PendingInteractionCardTarget = nullptr;
+}
+
+void ASurvivalPlayerController::ShowInteractionCard(UInteractionComponent* Interactable)
+{
+	if (!Interactable || !IsLocalController() || UE_SERVER)
+	{
+		return;
+	}
+
+	if (!InteractionCard && !InteractionCardClass.IsNull()) //first focus, create the one card we'll ever need
+	{
+		TSubclassOf<UInteractionWidget> CardClass = InteractionCardClass.Get();
+		if (!CardClass) //still streaming in
+		{
+			PendingInteractionCardTarget = Interactable;
+			return;
+		}
+
+		InteractionCard = CreateWidget<UInteractionWidget>(this, CardClass);
+
+		if (InteractionCard)
+		{
+			InteractionCard->SetAlignmentInViewport(FVector2D(0.5f, 0.5f)); //centered on the interactable like the widget component's default pivot
+			InteractionCard->AddToViewport();
+		}
+	}
+
+	if (InteractionCard)
+	{
+		InteractionCardTarget = Interactable;
+		InteractionCard->UpdateInteractionWidget(Interactable);
+		UpdateInteractionCardPosition();
+		InteractionCard->SetVisibility(ESlateVisibility::HitTestInvisible);
+	}
+}
+
+void ASurvivalPlayerController::HideInteractionCard(UInteractionComponent* Interactable)
+{
+	if (PendingInteractionCardTarget == Interactable)
+	{
+		PendingInteractionCardTarget = nullptr;
+	}
+
+	if (InteractionCard && InteractionCardTarget == Interactable) //something else may already have taken the card over
+	{
+		InteractionCardTarget = nullptr;
+		InteractionCard->SetVisibility(ESlateVisibility::Collapsed);
+	}
+}
+
+void ASurvivalPlayerController::RefreshInteractionCard(UInteractionComponent* Interactable)
+{
+	if (InteractionCard && InteractionCardTarget == Interactable)
+	{
+		InteractionCard->UpdateInteractionWidget(Interactable);
+	}
+}
+
+void ASurvivalPlayerController::PlayerTick(float DeltaTime)
+{
+	Super::PlayerTick(DeltaTime);
+
+	if (InteractionCardTarget.IsValid())
+	{
+		UpdateInteractionCardPosition();
+	}
+	else if (InteractionCard && InteractionCard->GetVisibility() != ESlateVisibility::Collapsed) //target was destroyed while focused
+	{
+		InteractionCard->SetVisibility(ESlateVisibility::Collapsed);
+	}
+}
+
+void ASurvivalPlayerController::UpdateInteractionCardPosition()
+{
+	FVector2D ScreenLocation;
+
+	if (InteractionCardTarget.IsValid() && ProjectWorldLocationToScreen(InteractionCardTarget->GetComponentLocation(), ScreenLocation, true))
+	{
+		InteractionCard->SetPositionInViewport(ScreenLocation, true);
+	}
+}
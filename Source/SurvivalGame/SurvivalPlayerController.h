@@ -13,5 +13,41 @@ UCLASS()
 class SURVIVALGAME_API ASurvivalPlayerController : public APlayerController
 {
 	GENERATED_BODY()
+
+public:
+
+	ASurvivalPlayerController();
+
+	//Shared interaction card, one widget for the local player that gets retargeted whenever focus changes
+	//Used by interaction components instead of a widget component each, see UInteractionComponent::ShowInteractionWidget
+	void ShowInteractionCard(class UInteractionComponent* Interactable);
+	void HideInteractionCard(class UInteractionComponent* Interactable);
+
+	//Update the card's contents, ignored if the card is showing a different interactable
+	void RefreshInteractionCard(class UInteractionComponent* Interactable);
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void PlayerTick(float DeltaTime) override;
+
+	//Widget class used for the shared interaction card, streamed in when a local player starts
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction")
+	TSoftClassPtr<class UInteractionWidget> InteractionCardClass;
+
+	//Something was focused before the card class finished loading, shown once it has
+	TWeakObjectPtr<class UInteractionComponent> PendingInteractionCardTarget;
+
+	void OnInteractionCardClassLoaded();
+
+	//Created the first time something is focused and reused from then on
+	UPROPERTY()
+	class UInteractionWidget* InteractionCard;
+
+	//The interactable the card is currently showing
+	TWeakObjectPtr<class UInteractionComponent> InteractionCardTarget;
+
+	//Keep the card over the interactable, only runs while the card is visible
+	void UpdateInteractionCardPosition();
 	
 };
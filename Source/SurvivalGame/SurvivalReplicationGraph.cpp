@@ -0,0 +1,286 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SurvivalReplicationGraph.h"
+#include "SurvivalCharacter.h"
+#include "World/Pickup.h"
+#include "World/LootCell.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+static TAutoConsoleVariable<int32> CVarUseReplicationGraph(
+	TEXT("survival.UseReplicationGraph"),
+	1,
+	TEXT("1 = game net driver uses the SurvivalGame replication graph (default)\n")
+	TEXT("0 = default per-actor relevancy. Only read when a net driver is created"),
+	ECVF_Default);
+
+USurvivalReplicationGraph::USurvivalReplicationGraph()
+{
+	GridCellSize = 10000.f; //100 meters
+	SpatialBias = FVector2D(-WORLD_MAX, -WORLD_MAX);
+
+	GridNode = nullptr;
+	AlwaysRelevantNode = nullptr;
+}
+
+void USurvivalReplicationGraph::RegisterReplicationDriver()
+{
+	UReplicationDriver::CreateReplicationDriverDelegate().BindLambda([](UNetDriver* ForNetDriver, const FURL& URL, UWorld* World) -> UReplicationDriver*
+	{
+		//beacons and demo recording keep the default driver
+		if (CVarUseReplicationGraph.GetValueOnGameThread() == 0 || !ForNetDriver || ForNetDriver->NetDriverName != NAME_GameNetDriver)
+		{
+			return nullptr;
+		}
+
+		return NewObject<USurvivalReplicationGraph>(GetTransientPackage());
+	});
+}
+
+ESurvivalActorRouting USurvivalReplicationGraph::GetActorRouting(const AActor* Actor)
+{
+	//the grid can't place an actor without a cull distance, e.g. a blueprint class loaded after the graph was set up
+	const bool bHasCullDistance = GlobalActorReplicationInfoMap.GetClassInfo(Actor->GetClass()).CullDistanceSquared > 0.f;
+
+	if (Actor->bAlwaysRelevant)
+	{
+		return ESurvivalActorRouting::AlwaysRelevant;
+	}
+
+	if (Actor->bOnlyRelevantToOwner)
+	{
+		return ESurvivalActorRouting::OwnerOnly;
+	}
+
+	if (!bHasCullDistance)
+	{
+		return ESurvivalActorRouting::AlwaysRelevant;
+	}
+
+	if (Actor->IsA<ASurvivalCharacter>())
+	{
+		return ESurvivalActorRouting::Dynamic;
+	}
+
+	//loot cells never move, they are placed in the cells their cull distance covers once
+	if (Actor->IsA<ALootCell>())
+	{
+		return ESurvivalActorRouting::Static;
+	}
+
+	//pooled pickups get moved when they are reused, so they can't be placed in the grid just once
+	if (Actor->IsA<APickup>() || Actor->IsRootComponentMovable())
+	{
+		return ESurvivalActorRouting::Dormancy;
+	}
+
+	return ESurvivalActorRouting::Static;
+}
+
+void USurvivalReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class) const
+{
+	const AActor* CDO = Class->GetDefaultObject<AActor>();
+
+	Info.CullDistanceSquared = CDO->NetCullDistanceSquared;
+
+	if (NetDriver && CDO->NetUpdateFrequency > 0.f)
+	{
+		Info.ReplicationPeriodFrame = FMath::Max<uint32>((uint32)FMath::RoundToFloat(NetDriver->NetServerMaxTickRate / CDO->NetUpdateFrequency), 1);
+	}
+
+	if (Class->IsChildOf(ASurvivalCharacter::StaticClass()))
+	{
+		Info.DistancePriorityScale = 1.f;
+		Info.StarvationPriorityScale = 1.f;
+	}
+	else if (Class->IsChildOf(APickup::StaticClass()) || Class->IsChildOf(ALootCell::StaticClass()))
+	{
+		Info.DistancePriorityScale = 0.5f; //barely change once placed, they don't need to be considered every frame
+	}
+	else if (Class->IsChildOf(APlayerState::StaticClass()))
+	{
+		Info.DistancePriorityScale = 0.f; //always relevant, distance means nothing
+	}
+}
+
+void USurvivalReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	//every replicated class gets its own cull distance and update period, lamps, doors and containers included
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+
+		if (!ActorCDO || !ActorCDO->GetIsReplicated())
+		{
+			continue;
+		}
+
+		//blueprint compile leftovers
+		if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_")))
+		{
+			continue;
+		}
+
+		FClassReplicationInfo ClassInfo;
+		InitClassReplicationInfo(ClassInfo, Class);
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+}
+
+void USurvivalReplicationGraph::InitGlobalGraphNodes()
+{
+	//pre-size the list pools so gathering doesn't allocate while playing
+	PreAllocateRepList(3, 12);
+	PreAllocateRepList(6, 12);
+	PreAllocateRepList(128, 64);
+	PreAllocateRepList(512, 16);
+
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = SpatialBias;
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void USurvivalReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	//also picks up the connection's own controller and view target (its character) every frame
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(ConnectionNode, RepGraphConnection);
+
+	FSurvivalConnectionNode& NewConnectionNode = ConnectionNodes.AddDefaulted_GetRef();
+	NewConnectionNode.NetConnection = RepGraphConnection->NetConnection;
+	NewConnectionNode.Node = ConnectionNode;
+}
+
+void USurvivalReplicationGraph::RemoveClientConnection(UNetConnection* NetConnection)
+{
+	ConnectionNodes.RemoveAllSwap([NetConnection](const FSurvivalConnectionNode& ConnectionNode) { return ConnectionNode.NetConnection == NetConnection; });
+
+	Super::RemoveClientConnection(NetConnection);
+}
+
+UReplicationGraphNode_AlwaysRelevant_ForConnection* USurvivalReplicationGraph::GetConnectionNode(UNetConnection* Connection) const
+{
+	if (Connection)
+	{
+		for (const FSurvivalConnectionNode& ConnectionNode : ConnectionNodes)
+		{
+			if (ConnectionNode.NetConnection == Connection)
+			{
+				return ConnectionNode.Node;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+void USurvivalReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetActorRouting(ActorInfo.Actor))
+	{
+	case ESurvivalActorRouting::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+
+	case ESurvivalActorRouting::OwnerOnly:
+		ActorsWithoutNetConnection.Add(ActorInfo.Actor); //owner is usually set after spawning, route it once replication starts
+		break;
+
+	case ESurvivalActorRouting::Dynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+
+	case ESurvivalActorRouting::Dormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+
+	case ESurvivalActorRouting::Static:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+	}
+}
+
+void USurvivalReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetActorRouting(ActorInfo.Actor))
+	{
+	case ESurvivalActorRouting::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+
+	case ESurvivalActorRouting::OwnerOnly:
+		if (ActorsWithoutNetConnection.RemoveSingleSwap(ActorInfo.Actor) == 0)
+		{
+			if (UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = GetConnectionNode(ActorInfo.Actor->GetNetConnection()))
+			{
+				ConnectionNode->NotifyRemoveNetworkActor(ActorInfo);
+			}
+		}
+		break;
+
+	case ESurvivalActorRouting::Dynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+
+	case ESurvivalActorRouting::Dormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+
+	case ESurvivalActorRouting::Static:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+	}
+}
+
+void USurvivalReplicationGraph::ResetGameWorldState()
+{
+	Super::ResetGameWorldState();
+
+	ActorsWithoutNetConnection.Reset();
+
+	for (const FSurvivalConnectionNode& ConnectionNode : ConnectionNodes)
+	{
+		if (ConnectionNode.Node)
+		{
+			ConnectionNode.Node->NotifyResetAllNetworkActors();
+		}
+	}
+}
+
+int32 USurvivalReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	for (int32 i = ActorsWithoutNetConnection.Num() - 1; i >= 0; --i)
+	{
+		AActor* Actor = ActorsWithoutNetConnection[i];
+
+		if (!Actor || Actor->IsPendingKill())
+		{
+			ActorsWithoutNetConnection.RemoveAtSwap(i);
+			continue;
+		}
+
+		if (UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = GetConnectionNode(Actor->GetNetConnection()))
+		{
+			ConnectionNode->NotifyAddNetworkActor(FNewReplicatedActorInfo(Actor));
+			ActorsWithoutNetConnection.RemoveAtSwap(i);
+		}
+	}
+
+	return Super::ServerReplicateActors(DeltaSeconds);
+}
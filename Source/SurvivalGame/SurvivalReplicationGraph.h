@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "SurvivalReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_AlwaysRelevant_ForConnection;
+
+//How an actor class is routed into the graph
+enum class ESurvivalActorRouting : uint8
+{
+	//in every connection's list: game state, player states, anything without a cull distance
+	AlwaysRelevant,
+
+	//only the owning connection: player controllers and anything else bOnlyRelevantToOwner
+	//owner only data on a shared actor (a character's inventory) can't be routed apart from it, the inventory filters by connection instead
+	OwnerOnly,
+
+	//grid, cell updated every frame: characters
+	Dynamic,
+
+	//grid, treated as static while dormant: pickups and other interactables that can move
+	Dormancy,
+
+	//grid, placed once: anything whose root can't move, and loot cells
+	Static
+};
+
+//Per-connection node and the connection it belongs to
+USTRUCT()
+struct FSurvivalConnectionNode
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UNetConnection* NetConnection = nullptr;
+
+	UPROPERTY()
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* Node = nullptr;
+};
+
+/**
+ * Replaces the default per-actor relevancy pass, which costs connections x actors every net tick.
+ * Actors are bucketed into a 2D grid once, so each connection only gathers the cells around it and
+ * the server's cost follows how crowded an area is rather than how big the world is.
+ * Each connection's own node always holds its controller and pawn, so the owner gets its inventory (replicated only to the owner,
+ * see UInventoryComponent::bReplicateToOwnerOnly) no matter where the grid puts the pawn, and nobody else is ever sent it.
+ * Enabled with survival.UseReplicationGraph (on by default), read when the net driver is created.
+ */
+UCLASS(Transient, Config = Engine)
+class SURVIVALGAME_API USurvivalReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+
+	USurvivalReplicationGraph();
+
+	//Hooks the graph up as the replication driver for the game net driver, call once at startup
+	static void RegisterReplicationDriver();
+
+	virtual void ResetGameWorldState() override;
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual void RemoveClientConnection(UNetConnection* NetConnection) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	//Size of a grid cell in cm, should be a good bit bigger than the largest cull distance
+	UPROPERTY(Config)
+	float GridCellSize;
+
+	//Lowest world X/Y, keeps cell coordinates positive
+	UPROPERTY(Config)
+	FVector2D SpatialBias;
+
+protected:
+
+	//Actors whose class has no cull distance go to the always relevant node, the grid can't place them
+	ESurvivalActorRouting GetActorRouting(const AActor* Actor);
+
+	//Update period and cull distance for a class, taken from its CDO's NetUpdateFrequency/NetCullDistanceSquared, plus priority scales for our own classes
+	void InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class) const;
+
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* GetConnectionNode(UNetConnection* Connection) const;
+
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+	UPROPERTY()
+	TArray<FSurvivalConnectionNode> ConnectionNodes;
+
+	//owner only actors that didn't have a connection yet when they were added, routed once they do
+	UPROPERTY()
+	TArray<AActor*> ActorsWithoutNetConnection;
+};
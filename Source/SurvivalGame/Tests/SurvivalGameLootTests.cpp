@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SurvivalGamePerfTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "Components/LootManagerComponent.h"
+#include "Items/ItemDefinition.h"
+
+//Run headless with: UE4Editor-Cmd SurvivalGame -nullrhi -unattended -ExecCmds="Automation RunTests SurvivalGame.Loot; Quit"
+
+static const int32 LootTestFlags = EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurvivalLootPromoteDemoteTest, "SurvivalGame.Loot.PromoteDemote", LootTestFlags)
+
+bool FSurvivalLootPromoteDemoteTest::RunTest(const FString& Parameters)
+{
+	FSurvivalPerfTestWorld TestWorld;
+
+	ULootManagerComponent* LootManager = TestWorld.SpawnLootManager();
+	if (!TestNotNull(TEXT("Loot manager"), LootManager))
+	{
+		return false;
+	}
+
+	UItemDefinition* Definition = NewObject<UItemDefinition>(GetTransientPackage());
+
+	//three loot together by the origin and two far enough away to be in another loot cell
+	const FVector NearLoot(0.f, 0.f, 0.f);
+	const FVector FarLoot(20000.f, 0.f, 0.f);
+
+	LootManager->AddDormantLoot(Definition, 1, FTransform(NearLoot));
+	LootManager->AddDormantLoot(Definition, 1, FTransform(NearLoot + FVector(50.f, 0.f, 0.f)));
+	LootManager->AddDormantLoot(Definition, 1, FTransform(NearLoot + FVector(0.f, 50.f, 0.f)));
+	LootManager->AddDormantLoot(Definition, 1, FTransform(FarLoot));
+	LootManager->AddDormantLoot(Definition, 1, FTransform(FarLoot + FVector(50.f, 0.f, 0.f)));
+
+	TestEqual(TEXT("All loot starts dormant"), LootManager->GetNumDormantLoot(), 5);
+	TestEqual(TEXT("Loot split into one cell per area"), LootManager->GetNumLootCells(), 2);
+
+	const FVector NobodyNear(5000.f, 5000.f, 0.f);
+
+	ASurvivalCharacter* FirstPlayer = TestWorld.SpawnPlayer(NobodyNear);
+	ASurvivalCharacter* SecondPlayer = TestWorld.SpawnPlayer(NobodyNear);
+
+	LootManager->UpdateLoot();
+	TestEqual(TEXT("Nothing promoted with nobody in range"), LootManager->GetNumPromotedLoot(), 0);
+
+	FirstPlayer->SetActorLocation(NearLoot);
+	LootManager->UpdateLoot();
+	TestEqual(TEXT("Loot in range of the first player promoted"), LootManager->GetNumPromotedLoot(), 3);
+	TestEqual(TEXT("Loot out of range stays dormant"), LootManager->GetNumDormantLoot(), 2);
+
+	LootManager->UpdateLoot();
+	TestEqual(TEXT("Promoted loot isn't promoted twice"), LootManager->GetNumPromotedLoot(), 3);
+
+	SecondPlayer->SetActorLocation(FarLoot);
+	LootManager->UpdateLoot();
+	TestEqual(TEXT("Loot in range of the second player promoted"), LootManager->GetNumPromotedLoot(), 5);
+	TestEqual(TEXT("No loot left dormant"), LootManager->GetNumDormantLoot(), 0);
+
+	//past the promotion distance (default pickup 200 + margin 100) but inside the hysteresis (x1.25)
+	FirstPlayer->SetActorLocation(NearLoot + FVector(340.f, 0.f, 0.f));
+	LootManager->UpdateLoot();
+	TestEqual(TEXT("Loot isn't demoted inside the hysteresis"), LootManager->GetNumPromotedLoot(), 5);
+
+	FirstPlayer->SetActorLocation(NobodyNear);
+	LootManager->UpdateLoot();
+	TestEqual(TEXT("Loot the first player left demoted"), LootManager->GetNumPromotedLoot(), 2);
+	TestEqual(TEXT("Demoted loot is dormant again"), LootManager->GetNumDormantLoot(), 3);
+
+	SecondPlayer->SetActorLocation(NobodyNear);
+	LootManager->UpdateLoot();
+	TestEqual(TEXT("Everything demoted once both players left"), LootManager->GetNumPromotedLoot(), 0);
+	TestEqual(TEXT("All loot dormant again"), LootManager->GetNumDormantLoot(), 5);
+	TestEqual(TEXT("Demoting reuses the existing cells"), LootManager->GetNumLootCells(), 2);
+
+	FirstPlayer->SetActorLocation(NearLoot);
+	LootManager->UpdateLoot();
+	TestEqual(TEXT("Demoted loot can be promoted again"), LootManager->GetNumPromotedLoot(), 3);
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
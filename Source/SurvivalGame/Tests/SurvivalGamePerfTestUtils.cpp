@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SurvivalGamePerfTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/IConsoleManager.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "AIController.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/InteractionComponent.h"
+#include "Components/LootManagerComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "SurvivalGameStateBase.h"
+
+static TAutoConsoleVariable<float> CVarPerfRegressionPercent(
+	TEXT("survival.PerfRegressionPercent"),
+	15.f,
+	TEXT("How much slower than the baseline, in percent, a SurvivalGame.Perf test can get before it fails"),
+	ECVF_Default);
+
+FSurvivalPerfTestWorld::FSurvivalPerfTestWorld()
+{
+	GameInstance = NewObject<UGameInstance>(GEngine);
+	GameInstance->AddToRoot();
+	GameInstance->InitializeStandalone(); //creates the world and initializes the subsystems
+
+	World = GameInstance->GetWorld();
+	World->InitializeActorsForPlay(FURL());
+	World->GetWorldSettings()->NotifyBeginPlay(); //no game mode to do it for us, everything spawned from here on begins play straight away
+}
+
+FSurvivalPerfTestWorld::~FSurvivalPerfTestWorld()
+{
+	//actors unregister from the subsystems as they end play, so they go before the game instance
+	for (const TWeakObjectPtr<AActor>& Actor : SpawnedActors)
+	{
+		if (Actor.IsValid())
+		{
+			Actor->Destroy();
+		}
+	}
+
+	GameInstance->Shutdown();
+	GameInstance->RemoveFromRoot();
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+ASurvivalCharacter* FSurvivalPerfTestWorld::SpawnCharacter(const FVector& Location, bool bPossess)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	ASurvivalCharacter* Character = World->SpawnActor<ASurvivalCharacter>(ASurvivalCharacter::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams);
+	SpawnedActors.Add(Character);
+
+	if (Character && bPossess)
+	{
+		AAIController* Controller = World->SpawnActor<AAIController>(SpawnParams);
+		SpawnedActors.Add(Controller);
+
+		Controller->Possess(Character);
+		Controller->SetControlRotation(FRotator::ZeroRotator);
+	}
+
+	return Character;
+}
+
+ASurvivalCharacter* FSurvivalPerfTestWorld::SpawnPlayer(const FVector& Location)
+{
+	ASurvivalCharacter* Character = SpawnCharacter(Location, false);
+
+	if (Character)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		//no player behind it, but it's in the world's player controller list like a connected player's would be
+		APlayerController* Controller = World->SpawnActor<APlayerController>(SpawnParams);
+		SpawnedActors.Add(Controller);
+
+		Controller->Possess(Character);
+	}
+
+	return Character;
+}
+
+ULootManagerComponent* FSurvivalPerfTestWorld::SpawnLootManager()
+{
+	ASurvivalGameStateBase* GameState = World->SpawnActor<ASurvivalGameStateBase>();
+	SpawnedActors.Add(GameState);
+
+	World->SetGameState(GameState);
+
+	return GameState ? GameState->LootManager : nullptr;
+}
+
+UInteractionComponent* FSurvivalPerfTestWorld::SpawnInteractable(const FVector& Location, float InteractionTime, bool bAsClient)
+{
+	AActor* Actor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Location));
+	SpawnedActors.Add(Actor);
+
+	if (bAsClient)
+	{
+		Actor->Role = ROLE_SimulatedProxy; //interaction components only outline for clients
+	}
+
+	UInteractionComponent* Interactable = NewObject<UInteractionComponent>(Actor, TEXT("Interaction"));
+	Interactable->bAllowMultipleInteractors = true;
+	Interactable->InteractionTime = InteractionTime;
+	Interactable->SetWorldLocation(Location);
+
+	Actor->SetRootComponent(Interactable);
+	Interactable->RegisterComponent(); //begins play and joins the interactable registry
+
+	if (bAsClient) //the primitive the outline goes on
+	{
+		UStaticMeshComponent* Mesh = NewObject<UStaticMeshComponent>(Actor, TEXT("Mesh"));
+		Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Mesh->SetupAttachment(Interactable);
+		Mesh->RegisterComponent();
+	}
+
+	return Interactable;
+}
+
+namespace SurvivalPerf
+{
+	double Measure(int32 Iterations, int32 Batches, TFunctionRef<void()> Body)
+	{
+		Body(); //warm up, first calls pay for allocations the rest reuse
+
+		double Best = MAX_dbl;
+
+		for (int32 Batch = 0; Batch < Batches; ++Batch)
+		{
+			const double Start = FPlatformTime::Seconds();
+
+			for (int32 i = 0; i < Iterations; ++i)
+			{
+				Body();
+			}
+
+			Best = FMath::Min(Best, FPlatformTime::Seconds() - Start);
+		}
+
+		return Best * 1e9 / FMath::Max(Iterations, 1);
+	}
+
+	static FString GetBaselinePath()
+	{
+		FString Path;
+		if (!FParse::Value(FCommandLine::Get(), TEXT("PerfBaseline="), Path))
+		{
+			Path = FPaths::ProjectSavedDir() / TEXT("Automation") / TEXT("SurvivalGamePerfBaseline.json");
+		}
+
+		return Path;
+	}
+
+	static TSharedPtr<FJsonObject> LoadJson(const FString& Path)
+	{
+		FString Contents;
+		TSharedPtr<FJsonObject> Json;
+
+		if (FFileHelper::LoadFileToString(Contents, *Path))
+		{
+			FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Contents), Json);
+		}
+
+		return Json.IsValid() ? Json : MakeShared<FJsonObject>();
+	}
+
+	static bool SaveJson(const FString& Path, const TSharedRef<FJsonObject>& Json)
+	{
+		FString Contents;
+		FJsonSerializer::Serialize(Json, TJsonWriterFactory<>::Create(&Contents));
+		return FFileHelper::SaveStringToFile(Contents, *Path);
+	}
+
+	bool CheckAgainstBaseline(FAutomationTestBase& Test, const FString& BenchmarkName, double NanosecondsPerIteration)
+	{
+		//every benchmark adds itself to the file, so one run leaves a complete set of results
+		const FString ResultsPath = FPaths::ProjectSavedDir() / TEXT("Automation") / TEXT("SurvivalGamePerfResults.json");
+		TSharedPtr<FJsonObject> Results = LoadJson(ResultsPath);
+		Results->SetNumberField(BenchmarkName, NanosecondsPerIteration);
+		SaveJson(ResultsPath, Results.ToSharedRef());
+
+		const FString BaselinePath = GetBaselinePath();
+		TSharedPtr<FJsonObject> Baseline = LoadJson(BaselinePath);
+
+		double BaselineNanoseconds = 0.0;
+		if (FParse::Param(FCommandLine::Get(), TEXT("PerfUpdateBaseline")) || !Baseline->TryGetNumberField(BenchmarkName, BaselineNanoseconds) || BaselineNanoseconds <= 0.0)
+		{
+			Baseline->SetNumberField(BenchmarkName, NanosecondsPerIteration);
+			SaveJson(BaselinePath, Baseline.ToSharedRef());
+
+			Test.AddInfo(FString::Printf(TEXT("%s: %.1f ns, recorded as the new baseline in %s"), *BenchmarkName, NanosecondsPerIteration, *BaselinePath));
+			return true;
+		}
+
+		const double ChangePercent = (NanosecondsPerIteration / BaselineNanoseconds - 1.0) * 100.0;
+		const float AllowedPercent = CVarPerfRegressionPercent.GetValueOnGameThread();
+
+		Test.AddInfo(FString::Printf(TEXT("%s: %.1f ns, baseline %.1f ns (%+.1f%%)"), *BenchmarkName, NanosecondsPerIteration, BaselineNanoseconds, ChangePercent));
+
+		if (ChangePercent > AllowedPercent)
+		{
+			Test.AddError(FString::Printf(TEXT("%s regressed %.1f%% against the baseline, %.1f%% allowed"), *BenchmarkName, ChangePercent, AllowedPercent));
+			return false;
+		}
+
+		return true;
+	}
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "SurvivalCharacter.h"
+#include "Components/InventoryComponent.h"
+
+class FAutomationTestBase;
+
+//Lets the perf tests reach the protected interaction code a player's input or the check subsystem would normally drive
+struct FSurvivalPerfTestAccess
+{
+	static void PerformInteractionCheck(ASurvivalCharacter* Character) { Character->PerformInteractionCheck(); }
+	static void FoundNewInteractable(ASurvivalCharacter* Character, class UInteractionComponent* Interactable) { Character->FoundNewInteractable(Interactable); }
+	static class UInteractionComponent* GetInteractable(const ASurvivalCharacter* Character) { return Character->GetInteractable(); }
+	static FInventoryList& GetReplicatedItems(UInventoryComponent* Inventory) { return Inventory->Items; }
+};
+
+/**
+ * A game world with its own game instance (so the subsystems exist) and no game mode, torn down with everything in it when this goes out of scope.
+ */
+class FSurvivalPerfTestWorld
+{
+public:
+
+	FSurvivalPerfTestWorld();
+	~FSurvivalPerfTestWorld();
+
+	FORCEINLINE UWorld* GetWorld() const { return World; }
+
+	//A character at Location facing +X, possessed by an AI controller (which counts as locally controlled here) if bPossess
+	ASurvivalCharacter* SpawnCharacter(const FVector& Location, bool bPossess = true);
+
+	//A character at Location possessed by a player controller, what the server measures loot promotion against
+	ASurvivalCharacter* SpawnPlayer(const FVector& Location);
+
+	//A game state with its loot manager, set as the world's game state so ULootManagerComponent::Get finds it
+	class ULootManagerComponent* SpawnLootManager();
+
+	//A bare actor with nothing but an interaction component, like a pickup without its mesh
+	//bAsClient gives it a mesh and a simulated proxy role, how a client sees a replicated pickup, so focusing it outlines it
+	class UInteractionComponent* SpawnInteractable(const FVector& Location, float InteractionTime = 0.f, bool bAsClient = false);
+
+private:
+
+	class UGameInstance* GameInstance;
+	UWorld* World;
+
+	TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+};
+
+/**
+ * Times a benchmark and compares it with the baseline file.
+ * The baseline lives in Saved/Automation/SurvivalGamePerfBaseline.json (-PerfBaseline=<path> to use another one, e.g. one checked in per test machine).
+ * A benchmark missing from the baseline, or any run with -PerfUpdateBaseline, writes its result into the baseline instead of comparing.
+ * Every run's results also go to Saved/Automation/SurvivalGamePerfResults.json.
+ * Fails the test when a result is more than survival.PerfRegressionPercent slower than the baseline.
+ */
+namespace SurvivalPerf
+{
+	//Runs Body Iterations times per batch and returns the fastest batch in nanoseconds per iteration, the least noisy number we can get
+	double Measure(int32 Iterations, int32 Batches, TFunctionRef<void()> Body);
+
+	//Records the result and checks it against the baseline, false (with an error on the test) if it regressed
+	bool CheckAgainstBaseline(FAutomationTestBase& Test, const FString& BenchmarkName, double NanosecondsPerIteration);
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,265 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SurvivalGamePerfTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+#include "Items/Item.h"
+#include "Items/ItemDefinition.h"
+#include "Subsystems/InteractionScheduler.h"
+#include "Subsystems/HighlightManager.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/DemoNetDriver.h"
+#include "Net/RepLayout.h"
+#include "UObject/CoreNet.h"
+
+//Run headless with: UE4Editor-Cmd SurvivalGame -nullrhi -unattended -ExecCmds="Automation RunTests SurvivalGame.Perf; Quit"
+//See SurvivalPerf::CheckAgainstBaseline for where results and the baseline live
+
+static const int32 PerfTestFlags = EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter;
+
+//Sizes of the scenarios, changing them invalidates the baseline
+static const int32 NumInteractablesInView = 64;
+static const int32 NumInventoryStacks = 32;
+static const int32 NumInteractors = 32;
+
+//Every interactable in front of the character, inside its check distance and cone
+static TArray<UInteractionComponent*> SpawnInteractablesInView(FSurvivalPerfTestWorld& TestWorld, const ASurvivalCharacter* Character, int32 Count, bool bAsClient = false)
+{
+	FVector EyesLoc;
+	FRotator EyesRot;
+	Character->GetActorEyesViewPoint(EyesLoc, EyesRot);
+
+	TArray<UInteractionComponent*> Interactables;
+
+	for (int32 i = 0; i < Count; ++i)
+	{
+		const float Distance = FMath::Lerp(150.f, 180.f, (float)i / Count); //inside the default 200 InteractionDistance of pickups
+		const float Side = ((i % 9) - 4) * 4.f;
+		const float Up = ((i / 9 % 5) - 2) * 4.f;
+
+		UInteractionComponent* Interactable = TestWorld.SpawnInteractable(EyesLoc + FVector(Distance, Side, Up), 0.f, bAsClient);
+		Interactable->InteractionDistance = 200.f;
+		Interactables.Add(Interactable);
+	}
+
+	return Interactables;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurvivalPerfInteractionCheckTest, "SurvivalGame.Perf.InteractionCheck", PerfTestFlags)
+
+bool FSurvivalPerfInteractionCheckTest::RunTest(const FString& Parameters)
+{
+	FSurvivalPerfTestWorld TestWorld;
+
+	ASurvivalCharacter* Character = TestWorld.SpawnCharacter(FVector::ZeroVector);
+	SpawnInteractablesInView(TestWorld, Character, NumInteractablesInView);
+
+	FSurvivalPerfTestAccess::PerformInteractionCheck(Character);
+	TestNotNull(TEXT("Something in view was focused"), FSurvivalPerfTestAccess::GetInteractable(Character));
+
+	//one full synchronous check: registry lookup, best candidate and the visibility trace
+	const double Nanoseconds = SurvivalPerf::Measure(1000, 5, [Character]()
+	{
+		FSurvivalPerfTestAccess::PerformInteractionCheck(Character);
+	});
+
+	return SurvivalPerf::CheckAgainstBaseline(*this, TEXT("InteractionCheck"), Nanoseconds);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurvivalPerfFocusChurnTest, "SurvivalGame.Perf.FocusChurn", PerfTestFlags)
+
+bool FSurvivalPerfFocusChurnTest::RunTest(const FString& Parameters)
+{
+	FSurvivalPerfTestWorld TestWorld;
+
+	ASurvivalCharacter* Character = TestWorld.SpawnCharacter(FVector::ZeroVector);
+	TArray<UInteractionComponent*> Interactables = SpawnInteractablesInView(TestWorld, Character, NumInteractablesInView, true);
+	UHighlightManager* HighlightManager = UHighlightManager::Get(TestWorld.GetWorld());
+
+	if (!TestNotNull(TEXT("Highlight manager"), HighlightManager))
+	{
+		return false;
+	}
+
+	UInteractionComponent* Focused = nullptr;
+	int32 Next = 0;
+
+	//the view sweeping across a pile of loot, focus moves to a different interactable every check
+	//and the frame's outline batch is applied, one outline off and one on
+	const double Nanoseconds = SurvivalPerf::Measure(1000, 5, [Character, HighlightManager, &Interactables, &Focused, &Next]()
+	{
+		if (Focused)
+		{
+			Focused->EndFocus(Character);
+		}
+
+		Focused = Interactables[Next];
+		Next = (Next + 1) % Interactables.Num();
+
+		Focused->BeginFocus(Character);
+		HighlightManager->Tick(0.f);
+	});
+
+	UStaticMeshComponent* FocusedMesh = Focused ? Focused->GetOwner()->FindComponentByClass<UStaticMeshComponent>() : nullptr;
+	TestTrue(TEXT("Focused interactable is outlined"), FocusedMesh && FocusedMesh->bRenderCustomDepth);
+
+	return SurvivalPerf::CheckAgainstBaseline(*this, TEXT("FocusChurn"), Nanoseconds);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurvivalPerfItemQuantityTest, "SurvivalGame.Perf.ItemSetQuantity", PerfTestFlags)
+
+bool FSurvivalPerfItemQuantityTest::RunTest(const FString& Parameters)
+{
+	FSurvivalPerfTestWorld TestWorld;
+
+	ASurvivalCharacter* Character = TestWorld.SpawnCharacter(FVector::ZeroVector);
+	UInventoryComponent* Inventory = Character->PlayerInventory;
+	Inventory->Capacity = 0;
+	Inventory->WeightCapacity = 0.f;
+
+	UItemDefinition* Definition = NewObject<UItemDefinition>(GetTransientPackage());
+	Definition->bCanStack = true;
+	Definition->MaxStackSize = 100;
+	Definition->Weight = 0.1f;
+
+	TArray<UItem*> Items;
+	for (int32 i = 0; i < NumInventoryStacks; ++i)
+	{
+		Items.Add(Inventory->AddItemFromDefinition(Definition, 10));
+	}
+
+	TestEqual(TEXT("Every stack was added"), Inventory->GetItems().Num(), NumInventoryStacks);
+
+	int32 Quantity = 10;
+
+	//every stack in the inventory changing at once, each change updates the aggregates and dirties its fast array entry for the next net update
+	const double Nanoseconds = SurvivalPerf::Measure(100, 5, [&Items, &Quantity]()
+	{
+		Quantity = Quantity == 10 ? 20 : 10;
+
+		for (UItem* Item : Items)
+		{
+			Item->SetQuantity(Quantity);
+		}
+	});
+
+	return SurvivalPerf::CheckAgainstBaseline(*this, TEXT("ItemSetQuantity"), Nanoseconds);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurvivalPerfInventoryNetDeltaTest, "SurvivalGame.Perf.InventoryNetDelta", PerfTestFlags)
+
+bool FSurvivalPerfInventoryNetDeltaTest::RunTest(const FString& Parameters)
+{
+	FSurvivalPerfTestWorld TestWorld;
+
+	ASurvivalCharacter* Character = TestWorld.SpawnCharacter(FVector::ZeroVector);
+	UInventoryComponent* Inventory = Character->PlayerInventory;
+	Inventory->Capacity = 0;
+	Inventory->WeightCapacity = 0.f;
+
+	UItemDefinition* Definition = NewObject<UItemDefinition>(GetTransientPackage());
+	Definition->bCanStack = true;
+	Definition->MaxStackSize = 100;
+
+	TArray<UItem*> Items;
+	for (int32 i = 0; i < NumInventoryStacks; ++i)
+	{
+		Items.Add(Inventory->AddItemFromDefinition(Definition, 10));
+	}
+
+	//struct layouts come from a net driver, nothing here needs a connection. The base package map writes no object GUIDs,
+	//so this times the fast array's own work: finding changed entries and writing them
+	UNetDriver* NetDriver = NewObject<UDemoNetDriver>(GetTransientPackage());
+	UPackageMap* PackageMap = NewObject<UPackageMap>(GetTransientPackage());
+	FNetSerializeCB NetSerializeCB(NetDriver);
+
+	FInventoryList& ReplicatedItems = FSurvivalPerfTestAccess::GetReplicatedItems(Inventory);
+	TSharedPtr<INetDeltaBaseState> LastState;
+	FNetBitWriter Writer(PackageMap, 8192);
+
+	//one net update for the owner: delta against what it was last sent
+	auto Flush = [&]() -> bool
+	{
+		Writer.Reset();
+
+		TSharedPtr<INetDeltaBaseState> NewState;
+
+		FNetDeltaSerializeInfo DeltaParms;
+		DeltaParms.Writer = &Writer;
+		DeltaParms.Map = PackageMap;
+		DeltaParms.NetSerializeCB = &NetSerializeCB;
+		DeltaParms.OldState = LastState.Get();
+		DeltaParms.NewState = &NewState;
+
+		const bool bWrote = ReplicatedItems.NetDeltaSerialize(DeltaParms);
+
+		if (NewState.IsValid())
+		{
+			LastState = NewState;
+		}
+
+		return bWrote;
+	};
+
+	TestTrue(TEXT("First update sends the whole inventory"), Flush());
+	TestFalse(TEXT("Nothing to send when nothing changed"), Flush());
+
+	int32 Quantity = 10;
+
+	//every stack changing between two net updates, the worst case for a flush
+	const double Nanoseconds = SurvivalPerf::Measure(100, 5, [&Items, &Quantity, &Flush]()
+	{
+		Quantity = Quantity == 10 ? 20 : 10;
+
+		for (UItem* Item : Items)
+		{
+			Item->SetQuantity(Quantity);
+		}
+
+		Flush();
+	});
+
+	TestTrue(TEXT("Changed stacks were written"), Writer.GetNumBits() > 0);
+
+	return SurvivalPerf::CheckAgainstBaseline(*this, TEXT("InventoryNetDelta"), Nanoseconds);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurvivalPerfInteractPercentageTest, "SurvivalGame.Perf.InteractPercentage", PerfTestFlags)
+
+bool FSurvivalPerfInteractPercentageTest::RunTest(const FString& Parameters)
+{
+	FSurvivalPerfTestWorld TestWorld;
+
+	UInteractionComponent* Interactable = TestWorld.SpawnInteractable(FVector(200.f, 0.f, 0.f), 60.f);
+	UInteractionScheduler* Scheduler = UInteractionScheduler::Get(TestWorld.GetWorld());
+
+	if (!TestNotNull(TEXT("Interaction scheduler"), Scheduler))
+	{
+		return false;
+	}
+
+	//nobody here is locally controlled, the server's worst case: every interactor is looked at before picking one
+	for (int32 i = 0; i < NumInteractors; ++i)
+	{
+		ASurvivalCharacter* Interactor = TestWorld.SpawnCharacter(FVector(0.f, i * 100.f, 0.f), false);
+		Interactable->BeginInteract(Interactor);
+		Scheduler->BeginSession(Interactor, Interactable, Interactable->InteractionTime);
+	}
+
+	float Percentage = 0.f;
+
+	const double Nanoseconds = SurvivalPerf::Measure(10000, 5, [Interactable, &Percentage]()
+	{
+		Percentage += Interactable->GetInteractPercentage();
+	});
+
+	TestTrue(TEXT("Progress is between 0 and 1"), Interactable->GetInteractPercentage() >= 0.f && Interactable->GetInteractPercentage() <= 1.f);
+
+	return SurvivalPerf::CheckAgainstBaseline(*this, TEXT("InteractPercentage"), Nanoseconds);
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LootCell.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Components/SceneComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Items/ItemDefinition.h"
+#include "Subsystems/AssetStreamingManager.h"
+#include "Subsystems/NetDormancyManager.h"
+#include "Net/UnrealNetwork.h"
+
+void FDormantLoot::PreReplicatedRemove(const FDormantLootList& InArraySerializer)
+{
+	if (InArraySerializer.OwnerCell)
+	{
+		InArraySerializer.OwnerCell->RemoveInstance(*this);
+	}
+}
+
+void FDormantLoot::PostReplicatedAdd(const FDormantLootList& InArraySerializer)
+{
+	Definition = ReplicatedDefinition.Definition;
+
+	if (InArraySerializer.OwnerCell)
+	{
+		InArraySerializer.OwnerCell->AddInstance(*this);
+	}
+}
+
+ALootCell::ALootCell()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	SetRootComponent(CreateDefaultSubobject<USceneComponent>("Root"));
+
+	DormantLoot.OwnerCell = this;
+
+	SetReplicates(true);
+	bAlwaysRelevant = false;
+	NetUpdateFrequency = 10.f; //only while awake, the dormancy manager puts cells back to sleep once their loot stops changing
+	NetCullDistanceSquared = FMath::Square(10000.f); //100 meters from the middle of the cell, loot further than that is just clutter
+}
+
+void ALootCell::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (HasAuthority())
+	{
+		if (UNetDormancyManager* DormancyManager = UNetDormancyManager::Get(this))
+		{
+			DormancyManager->RegisterActor(this);
+		}
+	}
+}
+
+void ALootCell::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (HasAuthority())
+	{
+		if (UNetDormancyManager* DormancyManager = UNetDormancyManager::Get(this))
+		{
+			DormancyManager->UnregisterActor(this);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ALootCell::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ALootCell, DormantLoot);
+}
+
+void ALootCell::AddLoot(const FDormantLoot& Loot)
+{
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	UNetDormancyManager::Wake(this);
+
+	FDormantLoot& NewLoot = DormantLoot.Entries.Add_GetRef(Loot);
+	NewLoot.InstanceIndex = INDEX_NONE;
+	DormantLoot.MarkItemDirty(NewLoot);
+
+	AddInstance(NewLoot);
+}
+
+bool ALootCell::RemoveLoot(int32 LootId, FDormantLoot& OutLoot)
+{
+	const int32 Index = DormantLoot.Entries.IndexOfByPredicate([LootId](const FDormantLoot& Loot) { return Loot.LootId == LootId; });
+
+	if (Index == INDEX_NONE || !HasAuthority())
+	{
+		return false;
+	}
+
+	UNetDormancyManager::Wake(this);
+
+	RemoveInstance(DormantLoot.Entries[Index]);
+
+	OutLoot = DormantLoot.Entries[Index];
+	DormantLoot.Entries.RemoveAtSwap(Index);
+	DormantLoot.MarkArrayDirty();
+
+	return true;
+}
+
+const FDormantLoot* ALootCell::FindLoot(int32 LootId) const
+{
+	return DormantLoot.Entries.FindByPredicate([LootId](const FDormantLoot& Loot) { return Loot.LootId == LootId; });
+}
+
+bool ALootCell::ShouldRenderInstances() const
+{
+	return !UE_SERVER && GetNetMode() != NM_DedicatedServer;
+}
+
+UHierarchicalInstancedStaticMeshComponent* ALootCell::FindOrCreateInstanceComponent(UStaticMesh* Mesh)
+{
+	for (UHierarchicalInstancedStaticMeshComponent* InstanceComponent : InstanceComponents)
+	{
+		if (InstanceComponent && InstanceComponent->GetStaticMesh() == Mesh)
+		{
+			return InstanceComponent;
+		}
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* InstanceComponent = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+	InstanceComponent->SetStaticMesh(Mesh);
+	InstanceComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision); //the promoted pickup handles collision and interaction
+	InstanceComponent->SetCanEverAffectNavigation(false);
+	InstanceComponent->SetCastShadow(false);
+	InstanceComponent->SetupAttachment(GetRootComponent());
+	InstanceComponent->RegisterComponent();
+
+	InstanceComponents.Add(InstanceComponent);
+
+	return InstanceComponent;
+}
+
+void ALootCell::AddInstance(FDormantLoot& Loot)
+{
+	if (!ShouldRenderInstances() || !Loot.Definition || Loot.Definition->PickupMesh.IsNull() || Loot.InstanceIndex != INDEX_NONE)
+	{
+		return;
+	}
+
+	UStaticMesh* Mesh = Loot.Definition->PickupMesh.Get();
+	if (!Mesh) //loot in the distance isn't urgent, it goes in once the mesh has streamed
+	{
+		if (UAssetStreamingManager* Streaming = UAssetStreamingManager::Get(this))
+		{
+			Streaming->RequestAsset(Loot.Definition->PickupMesh.ToSoftObjectPath(), EAssetStreamingPriority::Background,
+				FSimpleDelegate::CreateUObject(this, &ALootCell::OnInstanceMeshLoaded, Loot.Definition->PickupMesh));
+		}
+
+		return;
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* InstanceComponent = FindOrCreateInstanceComponent(Mesh);
+	const FTransform InstanceTransform(Loot.Rotation, Loot.Location);
+
+	TArray<int32>& FreeSlots = FreeInstanceSlots.FindOrAdd(InstanceComponent);
+	if (FreeSlots.Num() > 0)
+	{
+		Loot.InstanceIndex = FreeSlots.Pop(false);
+		InstanceComponent->UpdateInstanceTransform(Loot.InstanceIndex, InstanceTransform, true, true, true);
+	}
+	else
+	{
+		Loot.InstanceIndex = InstanceComponent->AddInstanceWorldSpace(InstanceTransform);
+	}
+}
+
+void ALootCell::RemoveInstance(FDormantLoot& Loot)
+{
+	//an instance only exists once its mesh has loaded, and the instanced component keeps that mesh loaded
+	if (Loot.InstanceIndex == INDEX_NONE || !Loot.Definition || !Loot.Definition->PickupMesh.Get())
+	{
+		return;
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* InstanceComponent = FindOrCreateInstanceComponent(Loot.Definition->PickupMesh.Get());
+
+	//collapse it instead of removing, removing would shift the indices every other loot holds
+	InstanceComponent->UpdateInstanceTransform(Loot.InstanceIndex, FTransform(FQuat::Identity, Loot.Location, FVector::ZeroVector), true, true, true);
+	FreeInstanceSlots.FindOrAdd(InstanceComponent).Add(Loot.InstanceIndex);
+
+	Loot.InstanceIndex = INDEX_NONE;
+}
+
+void ALootCell::OnInstanceMeshLoaded(TSoftObjectPtr<UStaticMesh> Mesh)
+{
+	for (FDormantLoot& Loot : DormantLoot.Entries)
+	{
+		if (Loot.InstanceIndex == INDEX_NONE && Loot.Definition && Loot.Definition->PickupMesh == Mesh)
+		{
+			AddInstance(Loot);
+		}
+	}
+}
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Engine/NetSerialization.h"
+#include "Subsystems/ItemRegistry.h"
+#include "LootCell.generated.h"
+
+//One idle pickup that only exists as a mesh instance until a player walks up to it
+USTRUCT()
+struct FDormantLoot : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	FDormantLoot()
+	{
+		LootId = INDEX_NONE;
+		Definition = nullptr;
+		Quantity = 0;
+		InstanceIndex = INDEX_NONE;
+	}
+
+	UPROPERTY()
+	int32 LootId;
+
+	//set from ReplicatedDefinition on clients when the entry arrives
+	UPROPERTY(NotReplicated)
+	class UItemDefinition* Definition;
+
+	//sent as an item registry id instead of an object reference
+	UPROPERTY()
+	FReplicatedItemDefinition ReplicatedDefinition;
+
+	UPROPERTY()
+	int32 Quantity;
+
+	UPROPERTY()
+	FVector_NetQuantize10 Location;
+
+	UPROPERTY()
+	FRotator Rotation;
+
+	//slot in the instanced mesh for Definition->PickupMesh, not replicated, every machine that renders keeps its own
+	int32 InstanceIndex;
+
+	//client side callbacks add/remove the instance
+	void PreReplicatedRemove(const struct FDormantLootList& InArraySerializer);
+	void PostReplicatedAdd(const struct FDormantLootList& InArraySerializer);
+};
+
+USTRUCT()
+struct FDormantLootList : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FDormantLoot> Entries;
+
+	UPROPERTY(NotReplicated)
+	class ALootCell* OwnerCell;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FDormantLoot, FDormantLootList>(Entries, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FDormantLootList> : public TStructOpsTypeTraitsBase2<FDormantLootList>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/**
+ * The dormant loot in one square of the world, spawned by ULootManagerComponent as loot is placed there.
+ * Cells are ordinary spatially relevant actors (static in the replication graph's grid, dormant between changes),
+ * so a client only gets, and only renders, the loot within NetCullDistanceSquared of it instead of the whole map's.
+ */
+UCLASS(NotPlaceable)
+class SURVIVALGAME_API ALootCell : public AActor
+{
+	GENERATED_BODY()
+
+	friend struct FDormantLoot;
+
+public:	
+
+	ALootCell();
+
+	//[server] Loot goes in as an instance, Loot.LootId must be unique across every cell
+	void AddLoot(const FDormantLoot& Loot);
+
+	//[server] Take a loot out of the cell, false if it isn't in this one
+	bool RemoveLoot(int32 LootId, FDormantLoot& OutLoot);
+
+	//[server] the loot without taking it out, null if it isn't in this one
+	const FDormantLoot* FindLoot(int32 LootId) const;
+
+	FORCEINLINE int32 GetNumLoot() const { return DormantLoot.Entries.Num(); }
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UPROPERTY(Replicated)
+	FDormantLootList DormantLoot;
+
+	//INSTANCES - not created on dedicated servers, nothing renders there
+	bool ShouldRenderInstances() const;
+
+	void AddInstance(FDormantLoot& Loot);
+	void RemoveInstance(FDormantLoot& Loot);
+
+	//Instances wait for their mesh to stream in, this adds every one still waiting on Mesh
+	void OnInstanceMeshLoaded(TSoftObjectPtr<class UStaticMesh> Mesh);
+
+	class UHierarchicalInstancedStaticMeshComponent* FindOrCreateInstanceComponent(class UStaticMesh* Mesh);
+
+	UPROPERTY()
+	TArray<class UHierarchicalInstancedStaticMeshComponent*> InstanceComponents;
+
+	//instance slots that were removed, reused before adding new instances
+	//instances are hidden rather than removed since removing one reorders the rest
+	TMap<class UHierarchicalInstancedStaticMeshComponent*, TArray<int32>> FreeInstanceSlots;
+};
@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Pickup.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Components/InteractionComponent.h"
+#include "Items/Item.h"
+#include "Items/ItemDefinition.h"
+#include "Subsystems/PickupPool.h"
+#include "Subsystems/NetDormancyManager.h"
+#include "Subsystems/AssetStreamingManager.h"
+#include "SurvivalCharacter.h"
+#include "Net/UnrealNetwork.h"
+
+#define LOCTEXT_NAMESPACE "Pickup"
+
+APickup::APickup()
+{
+	PrimaryActorTick.bCanEverTick = false; //pickups just sit there
+
+	PickupMesh = CreateDefaultSubobject<UStaticMeshComponent>("PickupMesh");
+	PickupMesh->SetCollisionResponseToChannel(ECC_Pawn, ECR_Ignore); //don't trip players up
+	SetRootComponent(PickupMesh);
+
+	InteractionComponent = CreateDefaultSubobject<UInteractionComponent>("PickupInteractionComponent");
+	InteractionComponent->SetupAttachment(PickupMesh);
+	InteractionComponent->InteractionTime = 0.f;
+	InteractionComponent->InteractionDistance = 200.f;
+	InteractionComponent->InteractionRadius = 30.f;
+	InteractionComponent->InteractableActionText = LOCTEXT("PickupActionText", "Take");
+
+	Item = nullptr;
+	PredictedTakeKey = 0;
+
+	SetReplicates(true);
+}
+
+void APickup::BeginPlay()
+{
+	Super::BeginPlay();
+
+	InteractionComponent->OnInteractNative.AddUObject(this, &APickup::OnTakePickup);
+	InteractionComponent->OnInteractRolledBackNative.AddUObject(this, &APickup::OnTakePickupRolledBack);
+}
+
+void APickup::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(APickup, PickupStack);
+}
+
+void APickup::InitializePickup(UItem* NewItem)
+{
+	if (!HasAuthority() || !NewItem || !NewItem->Definition)
+	{
+		return;
+	}
+
+	if (NewItem->OwningInventory) //coming straight out of someone's inventory
+	{
+		NewItem->OwningInventory->RemoveItem(NewItem);
+	}
+
+	UNetDormancyManager::Wake(this); //new contents have to go out even if we were asleep in the pool
+
+	Item = NewItem;
+	PickupStack = FInventoryItemStack(NewItem->Definition, NewItem->Quantity);
+
+	RefreshPickup();
+	ForceNetUpdate();
+}
+
+UItem* APickup::ResetPickup()
+{
+	UItem* OldItem = Item;
+
+	UNetDormancyManager::Wake(this);
+
+	Item = nullptr;
+	PickupStack = FInventoryItemStack();
+
+	RefreshPickup();
+
+	return OldItem;
+}
+
+void APickup::OnRep_PickupStack()
+{
+	PredictedTakeKey = 0; //the server has moved on, whatever we predicted is settled
+	RefreshPickup();
+}
+
+void APickup::RefreshPickup()
+{
+	const bool bActive = PickupStack.Definition != nullptr;
+
+	if (bActive)
+	{
+		StreamPickupMesh();
+		InteractionComponent->SetInteractableNameText(PickupStack.Definition->ItemDisplayName);
+		InteractionComponent->SetInteractionRadius(PickupStack.Definition->PickupRadius); //the mesh may not be loaded, and never is on a server
+		InteractionComponent->Activate(true);
+	}
+	else
+	{
+		InteractionComponent->Deactivate(); //also drops anyone still focusing or interacting with us
+	}
+
+	//hidden with collision off also stops it being relevant to clients while it sits in the pool
+	SetActorHiddenInGame(!bActive);
+	SetActorEnableCollision(bActive);
+}
+
+void APickup::StreamPickupMesh()
+{
+#if UE_SERVER
+	return; //the server only needs to know where the pickup is
+#else
+	if (UStaticMesh* LoadedMesh = PickupStack.Definition->PickupMesh.Get())
+	{
+		PickupMesh->SetStaticMesh(LoadedMesh);
+		return;
+	}
+
+	PickupMesh->SetStaticMesh(nullptr); //don't show whatever the pool last used us for while ours loads
+
+	if (UAssetStreamingManager* Streaming = UAssetStreamingManager::Get(this))
+	{
+		Streaming->RequestAsset(PickupStack.Definition->PickupMesh.ToSoftObjectPath(), EAssetStreamingPriority::High, FSimpleDelegate::CreateUObject(this, &APickup::OnPickupMeshLoaded));
+	}
+#endif
+}
+
+void APickup::OnPickupMeshLoaded()
+{
+	//we may have been recycled for something else while it loaded
+	if (PickupStack.Definition)
+	{
+		PickupMesh->SetStaticMesh(PickupStack.Definition->PickupMesh.Get());
+	}
+}
+
+void APickup::OnTakePickup(ASurvivalCharacter* Taker)
+{
+	if (!HasAuthority())
+	{
+		//predict the take: vanish and show the stack in the inventory now, the server confirms or rolls it back
+		const int32 PredictionKey = Taker ? Taker->GetInteractPredictionKey() : 0;
+
+		if (PredictionKey != 0 && Taker->PlayerInventory && PickupStack.Definition)
+		{
+			PredictedTakeKey = PredictionKey;
+			Taker->PlayerInventory->AddPredictedItem(PredictionKey, PickupStack.Definition, PickupStack.Quantity);
+
+			SetActorHiddenInGame(true);
+			SetActorEnableCollision(false);
+			InteractionComponent->Deactivate();
+		}
+
+		return;
+	}
+
+	if (!Taker || !Item || !Taker->PlayerInventory)
+	{
+		InteractionComponent->FailInteract();
+		return;
+	}
+
+	FInventoryTransaction Take; //merges into partial stacks the player already has
+	Take.ItemsToAdd.Emplace(Item->Definition, Item->Quantity);
+
+	if (Taker->PlayerInventory->ApplyTransaction(Take))
+	{
+		if (UPickupPool* Pool = UPickupPool::Get(this))
+		{
+			Pool->ReleasePickup(this);
+		}
+		else
+		{
+			Destroy();
+		}
+	}
+	else //no room, a predicting client has to put the pickup back
+	{
+		InteractionComponent->FailInteract();
+	}
+}
+
+void APickup::OnTakePickupRolledBack(ASurvivalCharacter* Taker, int32 PredictionKey)
+{
+	if (PredictionKey != PredictedTakeKey)
+	{
+		return;
+	}
+
+	//back to whatever the server last told us, if someone else grabbed it first that is still hidden
+	PredictedTakeKey = 0;
+	RefreshPickup();
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Components/InventoryComponent.h"
+#include "Pickup.generated.h"
+
+/**
+ * An item lying in the world. The server holds the actual UItem, clients only get its type and quantity.
+ * Pickups are recycled through UPickupPool rather than spawned/destroyed, so use UPickupPool::AcquirePickup to drop items.
+ */
+UCLASS()
+class SURVIVALGAME_API APickup : public AActor
+{
+	GENERATED_BODY()
+	
+public:	
+
+	APickup();
+
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UStaticMeshComponent* PickupMesh;
+
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UInteractionComponent* InteractionComponent;
+
+	//[server] Make this pickup represent the item, the pickup takes ownership of it
+	void InitializePickup(class UItem* NewItem);
+
+	//[server] Clear the pickup and hide it so the pool can hand it out again. Returns the item it was holding
+	class UItem* ResetPickup();
+
+	//true while sitting in the pool
+	FORCEINLINE bool IsPooled() const { return Item == nullptr; }
+
+	FORCEINLINE class UItem* GetItem() const { return Item; }
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+
+	//[server] the item players get when they take this pickup
+	UPROPERTY()
+	class UItem* Item;
+
+	//what clients need to show the pickup, cheaper than replicating the item as a subobject
+	UPROPERTY(ReplicatedUsing = OnRep_PickupStack)
+	FInventoryItemStack PickupStack;
+
+	UFUNCTION()
+	void OnRep_PickupStack();
+
+	//Mesh, name and visibility from PickupStack
+	void RefreshPickup();
+
+	//Pickups only exist near players (dormant loot is promoted to one as someone approaches), so the mesh streams in at high priority here
+	//never loaded on a dedicated server, the server only needs the pickup's location
+	void StreamPickupMesh();
+	void OnPickupMeshLoaded();
+
+	void OnTakePickup(class ASurvivalCharacter* Taker);
+
+	//[local] the server didn't let us have it after all
+	void OnTakePickupRolledBack(class ASurvivalCharacter* Taker, int32 PredictionKey);
+
+	//[local] key of the take we predicted, we stay hidden locally until the server answers it
+	int32 PredictedTakeKey;
+
+};